@@ -0,0 +1,97 @@
+// Adornment.h - Copyright (c) 2016 Will Cassella
+#pragma once
+
+#include <cassert>
+#include "ArgPack.h"
+
+namespace brolog
+{
+	/* The pattern of unified arguments a predicate is called with (its 'adornment'), when it is known at compile time.
+	 * Bit 'I' is set if argument 'I' is unified when the predicate is called. If it is clear the argument is usually not unified, but may be
+	 * if it is aliased with one that was unified since (such as when the same variable is given for two parameters of a rule).
+	 * Within a rule, this follows from which parameters were unified on entry and the arguments unified by the predicates satisfied before it.
+	 * Fact types and built-ins unify all of their arguments whenever they succeed, and custom predicates must do the same. Rules unify the
+	 * arguments that each of their clauses is sure to (see 'impl::unified_mask'). */
+	template <std::size_t Mask>
+	using Adornment = std::integral_constant<std::size_t, Mask>;
+
+	namespace impl
+	{
+		/* Evaluates to std::true_type if the given predicate (or fact store) declares an 'Adorned' member type, in which case it has
+		 * an overload of 'satisfy' taking an 'Adornment' as its last argument, std::false_type otherwise. */
+		template <typename T, typename = void>
+		struct is_adorned : std::false_type
+		{
+		};
+
+		template <typename T>
+		struct is_adorned < T, tmp::void_t<typename T::Adorned> > : std::true_type
+		{
+		};
+
+		/* Evaluates to the adornment of a predicate called with the given argument names, when the names in the given set (and any constants) are unified. */
+		template <typename Names, typename Bound, std::size_t I = 0>
+		struct adornment_of;
+
+		template <typename Bound, std::size_t I>
+		struct adornment_of < tmp::int_list<>, Bound, I > : std::integral_constant<std::size_t, 0>
+		{
+		};
+
+		template <int N, int ... Ns, typename Bound, std::size_t I>
+		struct adornment_of < tmp::int_list<N, Ns...>, Bound, I >
+			: std::integral_constant<std::size_t,
+				(is_constant_name<N>::value || tmp::element_of_int_list<N, Bound>::value ? std::size_t{ 1 } << I : 0) | adornment_of<tmp::int_list<Ns...>, Bound, I + 1>::value>
+		{
+		};
+
+		/* Evaluates to the adornment with every argument of the given "tmp::type_list<...>" unified. */
+		template <typename ArgTypeList>
+		struct full_adornment;
+
+		template <typename ... ArgTs>
+		struct full_adornment < tmp::type_list<ArgTs...> > : std::integral_constant<std::size_t, (std::size_t{ 1 } << sizeof...(ArgTs)) - 1>
+		{
+		};
+
+		template <typename PredT, std::size_t Mode, typename DBaseT, typename ArgPackT, typename ContinueFnT>
+		bool satisfy_adorned(std::true_type /*adorned*/, Adornment<Mode> mode, const DBaseT& dataBase, ArgPackT& args, const ContinueFnT& next)
+		{
+			return PredT::satisfy(dataBase, args, next, mode);
+		}
+
+		template <typename PredT, std::size_t Mode, typename DBaseT, typename ArgPackT, typename ContinueFnT>
+		bool satisfy_adorned(std::false_type /*adorned*/, Adornment<Mode> /*mode*/, const DBaseT& dataBase, ArgPackT& args, const ContinueFnT& next)
+		{
+			return PredT::satisfy(dataBase, args, next);
+		}
+
+		template <typename StoreT, std::size_t Mode, typename ArgPackT, typename ContinueFnT>
+		bool satisfy_store(std::true_type /*adorned*/, Adornment<Mode> mode, const StoreT& store, const ArgPackT& args, const ContinueFnT& next)
+		{
+			return store.satisfy(args, next, mode);
+		}
+
+		template <typename StoreT, std::size_t Mode, typename ArgPackT, typename ContinueFnT>
+		bool satisfy_store(std::false_type /*adorned*/, Adornment<Mode> /*mode*/, const StoreT& store, const ArgPackT& args, const ContinueFnT& next)
+		{
+			return store.satisfy(args, next);
+		}
+	}
+
+	/* Satisfies the given predicate with an 'arg pack' whose pattern of unified arguments is given by the adornment.
+	 * Adorned predicates use a version specialized for that pattern, the rest check which arguments are unified at runtime. */
+	template <typename PredT, std::size_t Mode, typename DBaseT, typename ArgPackT, typename ContinueFnT>
+	bool satisfy_adorned(Adornment<Mode> mode, const DBaseT& dataBase, ArgPackT& args, const ContinueFnT& next)
+	{
+		assert((arg_pack_unified_mask<0>(args) & Mode) == Mode);
+		return impl::satisfy_adorned<PredT>(impl::is_adorned<PredT>{}, mode, dataBase, args, next);
+	}
+
+	/* Unifies an 'arg pack' whose pattern of unified arguments is given by the adornment with every matching instance in the given fact store. */
+	template <typename StoreT, std::size_t Mode, typename ArgPackT, typename ContinueFnT>
+	bool satisfy_store(Adornment<Mode> mode, const StoreT& store, const ArgPackT& args, const ContinueFnT& next)
+	{
+		return impl::satisfy_store(impl::is_adorned<StoreT>{}, mode, store, args, next);
+	}
+}
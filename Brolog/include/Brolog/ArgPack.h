@@ -1,71 +1,80 @@
 // ArgPack.h - Copyright (c) 2016 Will Cassella
 #pragma once
 
+#include <array>
 #include <tuple>
 #include "VarChain.h"
 
 namespace brolog
 {
+	namespace impl
+	{
+		template <typename T, int N, typename ... VarChainTs>
+		Var<T>& get_arg_var(std::false_type /*constant*/, VarChainTs& ... varChains)
+		{
+			// Return the first VarChainElement in the set of var chains that has the requested variable type and name
+			return tmp::cast_first_suitable<VarChainElement<T, N>>(varChains...);
+		}
+
+		template <typename T, int N, typename ... VarChainTs>
+		Var<T>& get_arg_var(std::true_type /*constant*/, VarChainTs& ... /*varChains*/)
+		{
+			return ConstantVar<T, N>::get();
+		}
+	}
+
 	/* Creates an 'arg pack' for the given variable types and names, given a set of var chains.
 	 * This is used to create the tuple of variables for invoking a predicate. */
 	template <typename ... Ts, int ... Ns, typename ... VarChainTs>
 	std::tuple<Var<Ts>*...> create_arg_pack(tmp::type_list<Ts...> /*types*/, tmp::int_list<Ns...> /*names*/, VarChainTs& ... varChains)
 	{
-		// Return a pointer to the first VarChainElement in the set of var chains that has the requested variable type and name
-		return std::make_tuple(&tmp::cast_first_suitable<VarChainElement<Ts, Ns>>(varChains...)...);
+		return std::make_tuple(&impl::get_arg_var<Ts, Ns>(impl::is_constant_name<Ns>{}, varChains...)...);
 	}
 
-	/* Recursively unifies an 'arg pack', with a fact one element at a time. */
-	template <std::size_t I, typename T, typename ... Ts, typename ContinueFnT>
+	/* Recursively unifies an 'arg pack', with a fact one element at a time.
+	 * Returns false as soon as an element does not match, leaving any bindings already made to be undone by the caller. */
+	template <std::size_t I, typename T, typename ... Ts>
 	bool unify_arg_pack_element(
 		std::true_type,
 		const std::tuple<Var<T>*, Var<Ts>*...>& args,
-		const std::tuple<T, Ts...>& fact,
-		const ContinueFnT& next)
+		const std::tuple<T, Ts...>& fact)
 	{
 		// If the variable already has a value
 		if (std::get<I>(args)->unified())
 		{
 			// Continue only if the value is equivalent to the value in the fact
-			if (std::get<I>(args)->value() == std::get<I>(fact))
+			if (!(std::get<I>(args)->value() == std::get<I>(fact)))
 			{
-				return unify_arg_pack_element<I + 1>(std::integral_constant<bool, I < sizeof...(Ts)>{}, args, fact, next);
+				return false;
 			}
 		}
 		else
 		{
 			// Unify the var value with the fact value
 			std::get<I>(args)->unify(std::get<I>(fact));
-
-			// Continue
-			bool success = unify_arg_pack_element<I + 1>(std::integral_constant<bool, I < sizeof...(Ts)>{}, args, fact, next);
-
-			// Unbind the var
-			std::get<I>(args)->unbind();
-
-			return success;
 		}
 
-		return false;
+		return unify_arg_pack_element<I + 1>(std::integral_constant<bool, I < sizeof...(Ts)>{}, args, fact);
 	}
 
-	/* Recursive end-case for 'unify_arg_pack_element', all arguments have been unified, calls the continuation function. */
-	template <std::size_t I, typename ... Ts, typename ContinueFnT>
+	/* Recursive end-case for 'unify_arg_pack_element', all arguments have been unified. */
+	template <std::size_t I, typename ... Ts>
 	bool unify_arg_pack_element(
 		std::false_type,
 		const std::tuple<Var<Ts>*...>& /*args*/,
-		const std::tuple<Ts...>& /*fact*/,
-		const ContinueFnT& next)
+		const std::tuple<Ts...>& /*fact*/)
 	{
-		return next();
+		return true;
 	}
 
 	/* Unifies an 'arg pack' with a fact, calling the 'next' function when complete, or returning on failure.
-	 * Returns whether unification was successful. This may return false if this unification failed, or if failure occurred further on. */
+	 * Returns whether resolution should stop (as returned by 'next'), which is false if this unification failed.
+	 * Any bindings made are undone before returning. */
 	template <typename ... Ts, typename ContinueFnT>
 	bool unify_arg_pack(const std::tuple<Var<Ts>*...>& args, const std::tuple<Ts...>& fact, const ContinueFnT& next)
 	{
-		return unify_arg_pack_element<0>(std::integral_constant<bool, 0 < sizeof...(Ts)>{}, args, fact, next);
+		ChoicePoint choicePoint;
+		return unify_arg_pack_element<0>(std::integral_constant<bool, 0 < sizeof...(Ts)>{}, args, fact) && next();
 	}
 
 	/* Returns whether the given 'arg pack' has been completely unified, recursive. */
@@ -81,4 +90,78 @@ namespace brolog
 	{
 		return true;
 	}
+
+	/* Returns a bit mask of which elements of the given 'arg pack' have been unified (bit 'I' is set if element 'I' is unified), recursive. */
+	template <std::size_t I, typename TupleT>
+	auto arg_pack_unified_mask(const TupleT& argPack) -> std::enable_if_t<I < std::tuple_size<TupleT>::value, std::size_t>
+	{
+		return (std::get<I>(argPack)->unified() ? std::size_t{ 1 } << I : 0) | arg_pack_unified_mask<I + 1>(argPack);
+	}
+
+	/* Recursive end-case for 'arg_pack_unified_mask', no more members to look at. */
+	template <std::size_t I, typename TupleT>
+	auto arg_pack_unified_mask(const TupleT& /*argPack*/) -> std::enable_if_t<I >= std::tuple_size<TupleT>::value, std::size_t>
+	{
+		return 0;
+	}
+
+	namespace impl
+	{
+		template <std::size_t I, std::size_t J, typename TupleT>
+		bool arg_pack_elements_aliased(std::false_type /*comparable*/, const TupleT& /*argPack*/)
+		{
+			return false;
+		}
+
+		template <std::size_t I, std::size_t J, typename TupleT>
+		bool arg_pack_elements_aliased(std::true_type /*comparable*/, const TupleT& argPack)
+		{
+			return !std::get<I>(argPack)->unified() && std::get<I>(argPack)->aliases(*std::get<J>(argPack));
+		}
+
+		/* Implementation of 'arg_pack_aliases'. Each index in 'Ks' stands for the pair of elements (Ks / N, Ks % N), where 'N' is the
+		 * number of elements, so the pairs for each element are visited in order of the other element. */
+		template <typename ... Ts, std::size_t ... Ks>
+		std::array<std::size_t, sizeof...(Ts)> arg_pack_aliases(const std::tuple<Var<Ts>*...>& argPack, std::index_sequence<Ks...>)
+		{
+			constexpr std::size_t N = sizeof...(Ts);
+
+			std::array<std::size_t, N> result;
+			for (std::size_t i = 0; i < N; ++i)
+			{
+				result[i] = i;
+			}
+
+			using swallow = int[];
+			(void)swallow{ 0, (result[Ks / N] == Ks / N && arg_pack_elements_aliased<Ks / N, Ks % N>(
+				std::integral_constant<bool, (Ks % N < Ks / N) && std::is_same<std::tuple_element_t<Ks / N, std::tuple<Ts...>>, std::tuple_element_t<Ks % N, std::tuple<Ts...>>>::value>{},
+				argPack) ? (result[Ks / N] = Ks % N, 0) : 0)... };
+
+			return result;
+		}
+	}
+
+	/* Returns the pattern of aliasing among the elements of the given 'arg pack' that have not been unified: element 'I' of the result is
+	 * the position of the first element aliased with element 'I', or 'I' itself if there is none (or element 'I' is unified). */
+	template <typename ... Ts>
+	std::array<std::size_t, sizeof...(Ts)> arg_pack_aliases(const std::tuple<Var<Ts>*...>& argPack)
+	{
+		return impl::arg_pack_aliases(argPack, std::make_index_sequence<sizeof...(Ts) * sizeof...(Ts)>{});
+	}
+
+	/* Returns a tuple of the values of the elements of an 'arg pack' at the given indices.
+	 * NOTE: Those elements must have been unified. */
+	template <typename ... Ts, std::size_t ... Is>
+	std::tuple<std::tuple_element_t<Is, std::tuple<Ts...>>...> arg_pack_values(const std::tuple<Var<Ts>*...>& argPack, std::index_sequence<Is...>)
+	{
+		return std::tuple<std::tuple_element_t<Is, std::tuple<Ts...>>...>(std::get<Is>(argPack)->value()...);
+	}
+
+	/* Returns a tuple of the values of an 'arg pack'.
+	 * NOTE: The 'arg pack' must have been completely unified (check 'arg_pack_unified' first). */
+	template <typename ... Ts>
+	std::tuple<Ts...> arg_pack_values(const std::tuple<Var<Ts>*...>& argPack)
+	{
+		return arg_pack_values(argPack, std::index_sequence_for<Ts...>{});
+	}
 }
@@ -3,4 +3,5 @@
 
 #include "DataBase.h"
 #include "Fact.h"
+#include "MaterializedRule.h"
 #include "Rule.h"
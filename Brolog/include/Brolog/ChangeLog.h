@@ -0,0 +1,196 @@
+// ChangeLog.h - Copyright (c) 2016 Will Cassella
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <deque>
+#include <utility>
+#include <vector>
+
+namespace brolog
+{
+	/* Record of the instances inserted into or removed from a store (of a fact type or materialized rule), in order.
+	 * The generation of a store is the number of changes made to it, so a reader may find what changed since it last looked
+	 * by remembering the generation at that time.
+	 * Changes are only kept while a reader has subscribed (see 'subscribe'), and only until every reader has read them,
+	 * so a store that nothing reads the changes of only keeps its generation. At most 'MaxChanges' are kept: a reader that falls further
+	 * behind than that is dropped, and must read the store from scratch (see 'has_changes_since'). */
+	template <typename StoreT>
+	struct ChangeLog
+	{
+		/* The type of store that net changes are collected into (see 'get_changes'). */
+		using Store = StoreT;
+
+		using Instance = typename StoreT::Instance;
+
+		/* The greatest number of changes kept for readers. */
+		static constexpr std::size_t MaxChanges = std::size_t{ 1 } << 16;
+
+		////////////////////////
+		///   Constructors   ///
+	public:
+
+		ChangeLog() = default;
+		ChangeLog(const ChangeLog& copy)
+			: _generation(copy._generation),
+			_first(copy._generation)
+		{
+			// Readers belong to the original (such as the rule caches of the database it's in), so they and their changes are not copied
+		}
+
+		///////////////////
+		///   Methods   ///
+	public:
+
+		/* Returns the number of changes made so far. */
+		std::size_t generation() const
+		{
+			return _generation;
+		}
+
+		/* Records that the given instance was inserted (or removed, if 'inserted' is false). */
+		void push(const Instance& instance, bool inserted)
+		{
+			_generation += 1;
+
+			// Nothing could read this change, so don't keep it
+			if (_readers.empty())
+			{
+				_first = _generation;
+				return;
+			}
+
+			_changes.push_back(Change{ instance, inserted });
+
+			// Don't keep changes for a reader that has stopped reading them
+			if (_changes.size() > MaxChanges)
+			{
+				_changes.pop_front();
+				_first += 1;
+				this->drop_readers_behind(_first);
+			}
+		}
+
+		/* Records that the store was changed in a way that wasn't recorded (such as by an update that was interrupted by an exception),
+		 * so every reader must read it from scratch. */
+		void invalidate()
+		{
+			_generation += 1;
+			_first = _generation;
+			_changes.clear();
+			_readers.clear();
+		}
+
+		/* Returns whether the changes made since the given generation (returned by 'subscribe') are still kept, otherwise the reader was
+		 * dropped for falling too far behind, or the log was invalidated. */
+		bool has_changes_since(std::size_t generation) const
+		{
+			return generation >= _first;
+		}
+
+		/* Records that the given reader (any object identifying it, such as the answers of a materialized rule) has read every change
+		 * made so far, and will read the changes made from now on. Changes every reader has read are discarded.
+		 * Returns the current generation, to give to 'get_changes' when the reader next looks. */
+		std::size_t subscribe(const void* reader) const
+		{
+			auto found = std::find_if(_readers.begin(), _readers.end(), [reader](const Reader& r) { return r.first == reader; });
+			if (found == _readers.end())
+			{
+				_readers.push_back(Reader{ reader, _generation });
+			}
+			else
+			{
+				found->second = _generation;
+			}
+
+			// Discard the changes made before the generation the furthest behind reader last looked at
+			auto oldest = _generation;
+			for (const auto& r : _readers)
+			{
+				oldest = std::min(oldest, r.second);
+			}
+
+			while (_first < oldest)
+			{
+				_changes.pop_front();
+				_first += 1;
+			}
+
+			return _generation;
+		}
+
+		/* Adds the net changes made since the given generation to 'inserted' and 'removed', which should be empty.
+		 * An instance that was inserted and then removed again (or vice versa) is in neither.
+		 * The generation must be one returned by 'subscribe' (to a reader that hasn't subscribed again since), and 'has_changes_since' must be true for it. */
+		void get_changes(std::size_t generation, StoreT& inserted, StoreT& removed) const
+		{
+			assert(generation >= _first);
+			for (auto i = generation - _first; i < _changes.size(); ++i)
+			{
+				const auto& change = _changes[i];
+				auto& added = change.inserted ? inserted : removed;
+				auto& cancelled = change.inserted ? removed : inserted;
+
+				if (cancelled.contains(change.instance))
+				{
+					cancelled.remove(change.instance);
+				}
+				else
+				{
+					added.insert(change.instance);
+				}
+			}
+		}
+
+		/////////////////////
+		///   Operators   ///
+	public:
+
+		ChangeLog& operator=(const ChangeLog& copy)
+		{
+			_generation = copy._generation;
+			_first = copy._generation;
+			_changes.clear();
+			_readers.clear();
+
+			return *this;
+		}
+
+	private:
+
+		/* Removes the readers that last looked before the given generation, whose changes are no longer kept. */
+		void drop_readers_behind(std::size_t generation)
+		{
+			_readers.erase(std::remove_if(_readers.begin(), _readers.end(), [generation](const Reader& r) { return r.second < generation; }), _readers.end());
+
+			if (_readers.empty())
+			{
+				_changes.clear();
+				_first = _generation;
+			}
+		}
+
+		struct Change
+		{
+			Instance instance;
+			bool inserted;
+		};
+
+		/* A subscribed reader, and the generation it last looked at. */
+		using Reader = std::pair<const void*, std::size_t>;
+
+		//////////////////
+		///   Fields   ///
+	private:
+
+		std::size_t _generation = 0;
+
+		/* The generation of the first change in '_changes'. */
+		mutable std::size_t _first = 0;
+
+		mutable std::deque<Change> _changes;
+
+		mutable std::vector<Reader> _readers;
+	};
+}
@@ -0,0 +1,193 @@
+// Cursor.h - Copyright (c) 2016 Will Cassella
+#pragma once
+
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace brolog
+{
+	/* Pull-based view of the solutions to a query, returned by 'Query::cursor'.
+	 * The search is suspended after each solution and only resumed when the next is requested, so solutions are found as they're needed,
+	 * and memory is bounded by the depth of the search rather than the number of solutions. Destroying the cursor abandons the rest of the search.
+	 * The search runs on a thread owned by the cursor, which is started by the first call to 'next' and only runs while the owner is waiting
+	 * in 'next'. Other queries (and other cursors) may be run between solutions, but the database must not be modified while a cursor has a
+	 * suspended search. This header isn't included by the rest of the library, so only users of cursors depend on <thread>.
+	 * An exception thrown by the search (such as by a predicate) ends it, and is rethrown to the owner by 'next'.
+	 * 'QueryT' - The type of query (see 'Query'). */
+	template <typename QueryT>
+	struct Cursor
+	{
+		/* A "std::tuple<...>" of the values of the query's unique unknowns. */
+		using Answer = typename QueryT::Answer;
+
+		////////////////////////
+		///   Constructors   ///
+	public:
+
+		explicit Cursor(QueryT query)
+			: _state(std::make_unique<State>(std::move(query)))
+		{
+		}
+		Cursor(Cursor&& move) = default;
+		~Cursor()
+		{
+			if (!_thread.joinable())
+			{
+				return;
+			}
+
+			// Stop the search, if it isn't already finished
+			{
+				std::lock_guard<std::mutex> lock(_state->mutex);
+				_state->stop = true;
+				_state->searching = true;
+			}
+
+			_state->turn.notify_all();
+			_thread.join();
+		}
+
+		///////////////////
+		///   Methods   ///
+	public:
+
+		/* Finds the next solution, and returns whether there was one. If so, its values may be accessed with 'value' until the next call. */
+		bool next()
+		{
+			// The search thread isn't started until the first solution is requested
+			if (!_thread.joinable())
+			{
+				auto* state = _state.get();
+				_thread = std::thread([state]()
+				{
+					state->search();
+				});
+			}
+
+			std::unique_lock<std::mutex> lock(_state->mutex);
+			if (_state->done)
+			{
+				return false;
+			}
+
+			// Resume the search, and wait for it to suspend again
+			_state->searching = true;
+			_state->turn.notify_all();
+			_state->turn.wait(lock, [this]() { return !_state->searching; });
+
+			// Pass on an exception thrown by the search (which ended it)
+			if (_state->error)
+			{
+				auto error = _state->error;
+				_state->error = nullptr;
+				std::rethrow_exception(error);
+			}
+
+			return !_state->done;
+		}
+
+		/* Returns the values of the solution found by the last call to 'next'. Only valid if it returned true. */
+		const Answer& value() const
+		{
+			return *_state->answer;
+		}
+
+	private:
+
+		/* State shared between the owner of the cursor and the search thread. Only one of them runs at a time, as given by 'searching'. */
+		struct State
+		{
+			////////////////////////
+			///   Constructors   ///
+		public:
+
+			explicit State(QueryT query)
+				: query(std::move(query))
+			{
+			}
+
+			///////////////////
+			///   Methods   ///
+		public:
+
+			/* Run by the search thread. */
+			void search()
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				turn.wait(lock, [this]() { return searching; });
+
+				if (!stop)
+				{
+					lock.unlock();
+					std::exception_ptr thrown;
+					try
+					{
+						query.run_until([this](const auto& ... values) -> bool
+						{
+							const Answer value(values...);
+							std::unique_lock<std::mutex> lock(mutex);
+
+							// Give the solution to the owner, and wait until it wants another
+							answer = &value;
+							searching = false;
+							turn.notify_all();
+							turn.wait(lock, [this]() { return searching; });
+
+							answer = nullptr;
+							return stop;
+						});
+					}
+					catch (...)
+					{
+						// Exceptions can't leave the search thread, so give it to the owner instead
+						thrown = std::current_exception();
+					}
+					lock.lock();
+					error = thrown;
+				}
+
+				done = true;
+				searching = false;
+				turn.notify_all();
+			}
+
+			//////////////////
+			///   Fields   ///
+		public:
+
+			/* The query being searched, only used by the search thread. */
+			QueryT query;
+
+			std::mutex mutex;
+
+			std::condition_variable turn;
+
+			/* Whether it's the search thread's turn to run (otherwise the owner's). */
+			bool searching = false;
+
+			/* Whether the owner has abandoned the search. */
+			bool stop = false;
+
+			/* Whether the search has finished. */
+			bool done = false;
+
+			/* The exception that ended the search, until it is rethrown by 'next'. */
+			std::exception_ptr error;
+
+			/* The solution the search is suspended on, which lives on the search thread's stack. */
+			const Answer* answer = nullptr;
+		};
+
+		//////////////////
+		///   Fields   ///
+	private:
+
+		std::unique_ptr<State> _state;
+
+		std::thread _thread;
+	};
+}
@@ -2,7 +2,11 @@
 #pragma once
 
 #include <limits>
+#include <tuple>
+#include <utility>
+#include <vector>
 #include "ArgPack.h"
+#include "Table.h"
 
 namespace brolog
 {
@@ -12,32 +16,241 @@ namespace brolog
 	template <typename TypeT, typename Params, typename ... PredicateTs>
 	struct Rule;
 
+	/* Defined in "Cursor.h", which must be included to use 'Query::cursor'. */
+	template <typename QueryT>
+	struct Cursor;
+
+	/* Calls the given function with the values of the unique unknowns in the given arg pack, and returns whether it asked to stop the search. */
 	template <std::size_t I, int ... Ns, typename T, typename ... Ts, typename OutFnT, typename TupleT, typename ... ArgTs>
-	void output_unknowns(tmp::int_list<Ns...> names, tmp::type_list<T, Ts...>, const OutFnT& out, const TupleT& tuple, const ArgTs& ... args)
+	bool output_unknowns(tmp::int_list<Ns...> names, tmp::type_list<T, Ts...>, const OutFnT& out, const TupleT& tuple, const ArgTs& ... args)
 	{
-		output_unknowns<I + 1>(names, tmp::type_list<Ts...>{}, out, tuple, args...);
+		return output_unknowns<I + 1>(names, tmp::type_list<Ts...>{}, out, tuple, args...);
 	}
 
 	template <std::size_t I, int N, int ... Ns, typename ... Ts, typename OutFnT, typename TupleT, typename ... ArgTs>
 	auto output_unknowns(tmp::int_list<Ns...>, tmp::type_list<Unknown<N>, Ts...>, const OutFnT& out, const TupleT& tuple, const ArgTs& ... args) ->
-		std::enable_if_t<!tmp::element_of_int_list<N, tmp::int_list<Ns...>>::value>
+		std::enable_if_t<!tmp::element_of_int_list<N, tmp::int_list<Ns...>>::value, bool>
 	{
-		output_unknowns<I + 1>(tmp::int_list<N, Ns...>{}, tmp::type_list<Ts...>{}, out, tuple, args..., std::get<I>(tuple)->value());
+		return output_unknowns<I + 1>(tmp::int_list<N, Ns...>{}, tmp::type_list<Ts...>{}, out, tuple, args..., std::get<I>(tuple)->value());
 	}
 
 	template <std::size_t I, int N, int ... Ns, typename ... Ts, typename OutFnT, typename TupleT, typename ... ArgTs>
 	auto output_unknowns(tmp::int_list<Ns...> names, tmp::type_list<Unknown<N>, Ts...>, const OutFnT& out, const TupleT& tuple, const ArgTs& ... args) ->
-		std::enable_if_t<tmp::element_of_int_list<N, tmp::int_list<Ns...>>::value>
+		std::enable_if_t<tmp::element_of_int_list<N, tmp::int_list<Ns...>>::value, bool>
 	{
-		output_unknowns<I + 1>(names, tmp::type_list<Ts...>{}, out, tuple, args...);
+		return output_unknowns<I + 1>(names, tmp::type_list<Ts...>{}, out, tuple, args...);
 	}
 
 	template <std::size_t I, int ... Ns, typename OutFnT, typename TupleT, typename ... ArgTs>
-	void output_unknowns(tmp::int_list<Ns...>, tmp::type_list<>, const OutFnT& out, const TupleT& /*tuple*/, const ArgTs& ... args)
+	bool output_unknowns(tmp::int_list<Ns...>, tmp::type_list<>, const OutFnT& out, const TupleT& /*tuple*/, const ArgTs& ... args)
 	{
-		out(args...);
+		return out(args...);
 	}
 
+	/* Given a list of names already seen, the argument types of a term and the arguments given to a query for that term, evaluates to a
+	 * "std::tuple<...>" of the types of the query's unique unknowns, in the order 'output_unknowns' gives their values. */
+	template <typename Names, typename TermArgTypes, typename ArgTypes, typename ... Ts>
+	struct unknown_types;
+
+	template <int ... Ns, typename T, typename ... TermTs, typename ArgT, typename ... ArgTs, typename ... Ts>
+	struct unknown_types < tmp::int_list<Ns...>, tmp::type_list<T, TermTs...>, tmp::type_list<ArgT, ArgTs...>, Ts... >
+		: unknown_types<tmp::int_list<Ns...>, tmp::type_list<TermTs...>, tmp::type_list<ArgTs...>, Ts...>
+	{
+	};
+
+	template <int ... Ns, typename T, typename ... TermTs, int N, typename ... ArgTs, typename ... Ts>
+	struct unknown_types < tmp::int_list<Ns...>, tmp::type_list<T, TermTs...>, tmp::type_list<Unknown<N>, ArgTs...>, Ts... >
+		: std::conditional_t<tmp::element_of_int_list<N, tmp::int_list<Ns...>>::value,
+			unknown_types<tmp::int_list<Ns...>, tmp::type_list<TermTs...>, tmp::type_list<ArgTs...>, Ts...>,
+			unknown_types<tmp::int_list<N, Ns...>, tmp::type_list<TermTs...>, tmp::type_list<ArgTs...>, Ts..., T>>
+	{
+	};
+
+	template <int ... Ns, typename ... Ts>
+	struct unknown_types < tmp::int_list<Ns...>, tmp::type_list<>, tmp::type_list<>, Ts... >
+	{
+		using type = std::tuple<Ts...>;
+	};
+
+	/* Evaluates to the mask of the positions of the given arguments to a query that aren't 'Anonymous'. */
+	template <typename ArgTypes, std::size_t I = 0>
+	struct named_query_args;
+
+	template <typename ArgT, typename ... ArgTs, std::size_t I>
+	struct named_query_args < tmp::type_list<ArgT, ArgTs...>, I >
+		: std::integral_constant<std::size_t,
+			(std::is_same<ArgT, Anonymous>::value ? 0 : std::size_t{ 1 } << I) | named_query_args<tmp::type_list<ArgTs...>, I + 1>::value>
+	{
+	};
+
+	template <std::size_t I>
+	struct named_query_args < tmp::type_list<>, I > : std::integral_constant<std::size_t, 0>
+	{
+	};
+
+	/* A query against a database, returned by 'DataBase::create_query'.
+	 * Each way of running the query calls an output function each time the predicate is satisfied, with a number of parameters matching
+	 * the number of unique unknowns the query was created with. Queries that only need some of the solutions stop the search as soon as
+	 * they have them, rather than enumerating the rest.
+	 * A query may be run any number of times, and its 'Placeholder' arguments rebound between runs (see 'bind').
+	 * 'AnswerT' - A "std::tuple<...>" of the values of the query's unique unknowns, as given by a 'Cursor'. */
+	template <typename VarChainT, typename RunFnT, typename AnswerT>
+	struct Query
+	{
+		using Answer = AnswerT;
+
+		////////////////////////
+		///   Constructors   ///
+	public:
+
+		Query(VarChainT varChain, RunFnT run)
+			: _var_chain(std::move(varChain)),
+			_run(std::move(run))
+		{
+		}
+
+		///////////////////
+		///   Methods   ///
+	public:
+
+		/* Sets the values of the query's placeholder arguments for the following runs, where the value of 'Placeholder<N>' is the
+		 * Nth given value. This reuses the query's state, so it is much cheaper than creating a new query.
+		 * Every placeholder must be bound before the query is run. Returns this query, so it may be run immediately. */
+		template <typename ... ValueTs>
+		Query& bind(const ValueTs& ... values)
+		{
+			bind_placeholders<0>(_var_chain, values...);
+			return *this;
+		}
+
+		/* Calls the given function for each solution, in the order they are found, until it returns true.
+		 * Returns whether the search was stopped by the given function. */
+		template <typename OutFnT>
+		bool run_until(const OutFnT& out)
+		{
+			return _run(_var_chain, out);
+		}
+
+		/* Calls the given function for at most 'limit' solutions, in the order they are found.
+		 * Returns the number of times the given function was called. */
+		template <typename OutFnT>
+		std::size_t take(std::size_t limit, const OutFnT& out)
+		{
+			if (limit == 0)
+			{
+				return 0;
+			}
+
+			std::size_t numInvocations = 0;
+			_run(_var_chain, [&](const auto& ... values) -> bool
+			{
+				out(values...);
+				numInvocations += 1;
+
+				// Stop the search once the limit has been reached
+				return numInvocations >= limit;
+			});
+
+			return numInvocations;
+		}
+
+		/* Calls the given function for the first solution found, if any. Returns whether there was a solution. */
+		template <typename OutFnT>
+		bool first(const OutFnT& out)
+		{
+			return this->take(1, out) != 0;
+		}
+
+		/* Returns whether the query has any solutions. */
+		bool exists()
+		{
+			return _run(_var_chain, [](const auto& ... /*values*/) { return true; });
+		}
+
+		/* Runs the query once for each of the given keys, where each key is a tuple of values for the query's placeholders (as given to 'bind').
+		 * Calls the given function for every solution, with the index of the key it was found with as the first argument.
+		 * The keys share the state of a single run, so this is cheaper than binding and running the query for each key separately.
+		 * Returns the number of times the given function was called. */
+		template <typename KeysT, typename OutFnT>
+		std::size_t for_each_key(const KeysT& keys, const OutFnT& out)
+		{
+			// Tables of 'TabledRuleType' rules are reused for every key
+			QueryScope queryScope;
+
+			std::size_t numInvocations = 0;
+			std::size_t index = 0;
+
+			for (const auto& key : keys)
+			{
+				this->bind_key(key, std::make_index_sequence<std::tuple_size<std::decay_t<decltype(key)>>::value>{});
+				_run(_var_chain, [&](const auto& ... values) -> bool
+				{
+					out(index, values...);
+					numInvocations += 1;
+					return false;
+				});
+
+				index += 1;
+			}
+
+			return numInvocations;
+		}
+
+		/* Returns whether the query has any solutions for each of the given keys, in the same order (see 'for_each_key'). */
+		template <typename KeysT>
+		std::vector<bool> exists_each(const KeysT& keys)
+		{
+			// Tables of 'TabledRuleType' rules are reused for every key
+			QueryScope queryScope;
+
+			std::vector<bool> result;
+			result.reserve(keys.size());
+
+			for (const auto& key : keys)
+			{
+				this->bind_key(key, std::make_index_sequence<std::tuple_size<std::decay_t<decltype(key)>>::value>{});
+				result.push_back(_run(_var_chain, [](const auto& ... /*values*/) { return true; }));
+			}
+
+			return result;
+		}
+
+		/* Returns a cursor over the solutions to this query with its current placeholder values, which finds them one at a time
+		 * as they're requested (see 'Cursor', which must be included to use this). The cursor runs a copy of this query, so this query may be
+		 * rebound or run meanwhile. */
+		Cursor<Query> cursor() const
+		{
+			return Cursor<Query>(*this);
+		}
+
+	private:
+
+		template <typename KeyT, std::size_t ... Is>
+		void bind_key(const KeyT& key, std::index_sequence<Is...>)
+		{
+			this->bind(std::get<Is>(key)...);
+		}
+
+		/////////////////////
+		///   Operators   ///
+	public:
+
+		/* Calls the given function for every solution. Returns the number of times the given function was called. */
+		template <typename OutFnT>
+		std::size_t operator()(const OutFnT& out)
+		{
+			return this->take(std::numeric_limits<std::size_t>::max(), out);
+		}
+
+		//////////////////
+		///   Fields   ///
+	private:
+
+		VarChainT _var_chain;
+
+		RunFnT _run;
+	};
+
 	/* A database of rules and facts of the given types. May be used to satisfy queries against those rules and facts. */
 	template <typename ... ElementTs>
 	struct DataBase : DataBaseElement<DataBase<ElementTs...>, ElementTs>...
@@ -62,6 +275,35 @@ namespace brolog
 			FactT::remove_instance(*this, std::forward<Args>(args)...);
 		}
 
+		/* Returns the object storing all instances of the given type of fact in the database, for configuring the fact type's
+		 * storage policy (such as reserving the region covered by a 'GridStorage').
+		 * The given fact type must be a type supported by this database.
+		 */
+		template <typename FactT>
+		typename FactT::Store& get_fact_store()
+		{
+			return static_cast<DataBaseElement<DataBase, FactT>&>(*this).instances;
+		}
+
+		/* Returns the number of times instances of the given type of fact have been inserted into or removed from the database
+		 * (inserting an existing instance or removing a missing one does not count). Used to detect when cached answers are out of date.
+		 * The given fact type must be a type supported by this database.
+		 */
+		template <typename FactT>
+		std::size_t get_generation() const
+		{
+			return static_cast<const DataBaseElement<DataBase, FactT>&>(*this).changes.generation();
+		}
+
+		/* Returns the data of the given type that the given rule type keeps in this database between queries (see 'CachedRuleType').
+		 * This is modified by queries, so queries using cached rule types must not be run on the same database concurrently.
+		 */
+		template <typename RuleT, typename T>
+		T& get_rule_cache() const
+		{
+			return _rule_cache.get<RuleT, T>();
+		}
+
 		/* Inserts an instance of the given type of rule into the database.
 		 * The 'Params' argument should be of the form "Params<...>", to declare parameters for this scope.
 		 * The set of Predicates should be of the form "Satisfy<...>" or "NotSatisfy<...>".
@@ -76,10 +318,14 @@ namespace brolog
 		}
 
 		/* Constructs a query object that can resolve the given predicate with the given arguments.
-		 * You may use the 'Unknown<VAR>' type to indicate an unknown variable.
+		 * You may use the 'Unknown<VAR>' type to indicate an unknown variable, the 'Anonymous' type for an unknown variable whose value
+		 * isn't needed, and the 'Placeholder<N>' type to indicate a value given later with 'Query::bind'. If the query has anonymous
+		 * arguments but no unknowns, the search stops at the first solution.
 		 * The returned object may be called with the function call operator to run the query. It's only argument
 		 * should be a function to call each time the predicate is satisfied, with a number of parameters matching the number of unique unknowns
 		 * given to this function. The query object returns the number of times the given function was called.
+		 * Use 'first', 'exists', or 'take' on the returned object instead when only some of the solutions are needed, 'for_each_key'
+		 * or 'exists_each' to run it for many sets of placeholder values at once, and 'cursor' to pull solutions one at a time (see 'Query').
 		 * The returned query object remains valid even if rules or facts are added or removed from the database.
 		 */
 		template <typename TermT, typename ... ArgTs>
@@ -90,33 +336,40 @@ namespace brolog
 			fill_user_var_chain<std::numeric_limits<int>::max()>(varChain, args...);
 			auto nameList = get_user_var_chain_name_list<std::numeric_limits<int>::max()>(tmp::int_list<>{}, tmp::type_list<ArgTs...>{});
 
-			// The query object that is returned to the caller
-			// First argument is a function to call at each unification
-			return [=](const auto& out) mutable -> std::size_t
+			// Whether the query has anonymous arguments, but no unknowns
+			using Answer = typename unknown_types<tmp::int_list<>, typename TermT::ArgTypes, tmp::type_list<ArgTs...>>::type;
+			using Existential = std::integral_constant<bool,
+				tmp::element_of<tmp::type_list<ArgTs...>, Anonymous>::value && std::tuple_size<Answer>::value == 0>;
+
+			// The predicate to satisfy, given which of the arguments are anonymous
+			using PredT = typename impl::named_args<TermT, named_query_args<tmp::type_list<ArgTs...>>::value>::type;
+
+			// The function run by the query object that is returned to the caller
+			// First argument is the query's var chain, second is a function to call at each unification, which returns whether to stop
+			auto run = [this, nameList](auto& varChain, const auto& out) -> bool
 			{
+				// Tables of 'TabledRuleType' rules are only reused within this query
+				QueryScope queryScope;
+
 				// Create an arg pack to kick off the predicate
 				auto argPack = create_arg_pack(typename TermT::ArgTypes{}, nameList, varChain);
 
-				// The number of times the predicate was satisfied
-				std::size_t numInvocations = 0;
-
-				// Construct an end 'next' function to be called when the predicate is satisfied.
+				// Construct an end 'next' function to be called when the predicate is satisfied, which calls the given output function
+				// Every solution to an existential query is the same, so the search stops after the first
 				auto end = [&]() -> bool
 				{
-					// Call the given output function
-					output_unknowns<0>(tmp::int_list<>{}, tmp::type_list<ArgTs...>{}, out, argPack);
-					numInvocations += 1;
-
-					// Return 'true' so that the outer predicate knows it was resolved
-					return true;
+					return output_unknowns<0>(tmp::int_list<>{}, tmp::type_list<ArgTs...>{}, out, argPack) || Existential::value;
 				};
 
 				// Run the predicate
-				TermT::satisfy(*this, argPack, end);
-
-				// Return the number of times the output function was called
-				return numInvocations;
+				return PredT::satisfy(*this, argPack, end);
 			};
+
+			return Query<decltype(varChain), decltype(run), Answer>(std::move(varChain), std::move(run));
 		}
+
+	private:
+
+		mutable RuleCache _rule_cache;
 	};
 }
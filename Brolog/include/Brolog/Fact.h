@@ -1,17 +1,20 @@
 // Fact.h - Copyright (c) 2016 Will Cassella
 #pragma once
 
-#include <set>
+#include "Adornment.h"
 #include "ArgPack.h"
+#include "ChangeLog.h"
 #include "DataBase.h"
+#include "Storage/Ordered.h"
 
 namespace brolog
 {
-	/* Type defining a 'Fact Type'.
+	/* Type defining a 'Fact Type', with a given storage policy.
 	 * 'CookieT' - Any unique type, not necesarily defined. Used to disambiguate this FacType from any others that
-	 * take the same arguments. */
-	template <typename CookieT, typename ... ArgTs>
-	struct FactType
+	 * take the same arguments.
+	 * 'StorageT' - The policy for how instances of this FactType are stored in the database (such as 'OrderedStorage<...>'). */
+	template <typename CookieT, typename StorageT, typename ... ArgTs>
+	struct BasicFactType
 	{
 		/* The type of object that is stored in the database for each instance of this FactType. */
 		using Instance = std::tuple<ArgTs...>;
@@ -19,48 +22,78 @@ namespace brolog
 		/* The list of argument types required to satisfy this FactType. */
 		using ArgTypes = tmp::type_list<ArgTs...>;
 
+		/* The type of object that stores all instances of this FactType in the database. */
+		using Store = typename StorageT::template Store<ArgTs...>;
+
+		/* The type of record of changes made to the instances of this FactType (see 'get_changes'). */
+		using Changes = ChangeLog<Store>;
+
+		/* Fact types pass their 'Adornment' on to their store, if it is adorned. */
+		using Adorned = std::true_type;
+
 		template <typename DBaseT, typename ContinueFnT>
 		static bool satisfy(const DBaseT& dataBase, const std::tuple<Var<ArgTs>*...>& args, const ContinueFnT& next)
 		{
-			const auto& instances = static_cast<const DataBaseElement<DBaseT, FactType>&>(dataBase).instances;
-			bool initiallyUnified = arg_pack_unified<0>(args);
-			bool satisfied = false;
+			return static_cast<const DataBaseElement<DBaseT, BasicFactType>&>(dataBase).instances.satisfy(args, next);
+		}
 
-			// While we haven't run out of facts, and we haven't found a fact that matches the arguments (if it the arguments were initally unified)
-			for (auto fact = instances.begin(); fact != instances.end() && !(initiallyUnified && satisfied); ++fact)
-			{
-				// Unify the argumentss
-				satisfied |= unify_arg_pack(args, *fact, next);
-			}
+		template <typename DBaseT, typename ContinueFnT, std::size_t Mode>
+		static bool satisfy(const DBaseT& dataBase, const std::tuple<Var<ArgTs>*...>& args, const ContinueFnT& next, Adornment<Mode> mode)
+		{
+			return satisfy_store(mode, static_cast<const DataBaseElement<DBaseT, BasicFactType>&>(dataBase).instances, args, next);
+		}
 
-			return satisfied;
+		/* Returns the record of changes made to the instances of this fact in the database (see 'ChangeLog'). */
+		template <typename DBaseT>
+		static const Changes& get_changes(const DBaseT& dataBase)
+		{
+			return static_cast<const DataBaseElement<DBaseT, BasicFactType>&>(dataBase).changes;
 		}
 
 		/* Creates a new instance of this fact and inserts it into the database. */
 		template <typename DBaseT>
 		static void make_instance(DBaseT& dataBase, ArgTs ... values)
 		{
-			static_cast<DataBaseElement<DBaseT, FactType>&>(dataBase).instances.insert(std::make_tuple(std::forward<ArgTs>(values)...));
+			auto& element = static_cast<DataBaseElement<DBaseT, BasicFactType>&>(dataBase);
+			const auto instance = std::make_tuple(std::forward<ArgTs>(values)...);
+			const auto size = element.instances.size();
+			element.instances.insert(instance);
+
+			// Only record insertions that changed the store, so that answers derived from it stay valid otherwise
+			if (element.instances.size() != size)
+			{
+				element.changes.push(instance, true);
+			}
 		}
 
 		/* Removes an instance of this fact from the database. */
 		template <typename DBaseT>
 		static void remove_instance(DBaseT& database, ArgTs ... values)
 		{
-			auto& instances = static_cast<DataBaseElement<DBaseT, FactType>&>(database).instances;
-			auto instance = std::make_tuple(std::forward<ArgTs>(values)...);
+			auto& element = static_cast<DataBaseElement<DBaseT, BasicFactType>&>(database);
+			const auto instance = std::make_tuple(std::forward<ArgTs>(values)...);
+			const auto size = element.instances.size();
+			element.instances.remove(instance);
 
-			auto pos = instances.find(instance);
-			if (pos != instances.end())
+			if (element.instances.size() != size)
 			{
-				instances.erase(pos);
+				element.changes.push(instance, false);
 			}
 		}
 	};
 
-	template <typename DBase, typename Cookie, typename ... Ts>
-	struct DataBaseElement < DBase, FactType<Cookie, Ts...> >
+	/* Type defining a 'Fact Type', whose instances are stored in an ordered set.
+	 * 'CookieT' - Any unique type, not necesarily defined. Used to disambiguate this FacType from any others that
+	 * take the same arguments. */
+	template <typename CookieT, typename ... ArgTs>
+	using FactType = BasicFactType<CookieT, OrderedStorage<>, ArgTs...>;
+
+	template <typename DBase, typename Cookie, typename StorageT, typename ... Ts>
+	struct DataBaseElement < DBase, BasicFactType<Cookie, StorageT, Ts...> >
 	{
-		std::set<typename FactType<Cookie, Ts...>::Instance> instances;
+		typename BasicFactType<Cookie, StorageT, Ts...>::Store instances;
+
+		/* Every change made to 'instances' (see 'DataBase::get_generation'). */
+		typename BasicFactType<Cookie, StorageT, Ts...>::Changes changes;
 	};
 }
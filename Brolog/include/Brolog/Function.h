@@ -74,6 +74,7 @@ namespace brolog
 	};
 
 	/* Function called at each step to continue resolution.
-	 * Returns whether resolution succeeded or failed. */
+	 * Returns whether resolution should stop, in which case every predicate abandons its search and returns true as well
+	 * (such as when a query has all the answers it needs). Returns false to backtrack and look for more solutions. */
 	using ContinueFn = Function<bool()>;
 }
\ No newline at end of file
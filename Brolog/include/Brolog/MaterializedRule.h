@@ -0,0 +1,865 @@
+// MaterializedRule.h - Copyright (c) 2016 Will Cassella
+#pragma once
+
+#include <vector>
+#include "ChangeLog.h"
+#include "Rule.h"
+
+namespace brolog
+{
+	namespace impl
+	{
+		/* The ways a materialized rule's clauses are evaluated, which determine what the predicates in each clause are substituted with. */
+		enum class MaterializePhase
+		{
+			/* Finding every answer from scratch. */
+			Evaluate,
+
+			/* Finding answers whose derivations used instances of other predicates that have since changed (in the state before the change). */
+			Remove,
+
+			/* Finding answers that have new derivations using instances of other predicates that have changed. */
+			Insert
+		};
+
+		/* The kinds of predicate found in a materialized rule's clauses. */
+		enum class PredicateKind
+		{
+			/* A predicate whose changes are not recorded, which is either constant or causes the rule to be evaluated from scratch when it changes. */
+			Other,
+
+			/* A direct call to the materialized rule. */
+			Self,
+
+			/* A predicate whose changes are recorded (a fact type or another materialized rule), so the rule may be maintained incrementally. */
+			Source
+		};
+
+		/* Evaluates to std::true_type if the given predicate records its changes with a 'ChangeLog', std::false_type otherwise. */
+		template <typename PredT, typename = void>
+		struct has_changes : std::false_type
+		{
+		};
+
+		template <typename PredT>
+		struct has_changes < PredT, tmp::void_t<typename PredT::Changes> > : std::true_type
+		{
+		};
+
+		/* Evaluates to the kind of the given predicate (of the form "Satisfy<...>" or "NotSatisfy<...>") in the clauses of the given rule. */
+		template <typename RuleT, typename PredicateT>
+		struct predicate_kind : std::integral_constant<PredicateKind,
+			std::is_same<typename predicate_type<PredicateT>::type, RuleT>::value ? PredicateKind::Self :
+			has_changes<typename predicate_type<PredicateT>::type>::value ? PredicateKind::Source : PredicateKind::Other>
+		{
+		};
+
+		/* Given a type_list of predicate types, evaluates to a type_list of the distinct predicates that record their changes (excluding 'RuleT'). */
+		template <typename RuleT, typename PredicateList, typename Result = tmp::type_list<>>
+		struct collect_sources;
+
+		template <typename RuleT, typename PredT, typename ... PredTs, typename ... Rs>
+		struct collect_sources < RuleT, tmp::type_list<PredT, PredTs...>, tmp::type_list<Rs...> >
+			: collect_sources<RuleT, tmp::type_list<PredTs...>, std::conditional_t<
+				has_changes<PredT>::value && !std::is_same<PredT, RuleT>::value && !tmp::element_of<tmp::type_list<Rs...>, PredT>::value,
+				tmp::type_list<Rs..., PredT>,
+				tmp::type_list<Rs...>>>
+		{
+		};
+
+		template <typename RuleT, typename Result>
+		struct collect_sources < RuleT, tmp::type_list<>, Result >
+		{
+			using type = Result;
+		};
+
+		/* Substitutes a predicate in a materialized rule's clause. 'ViewsT' gives the rule type ('Self'), and the predicates to substitute
+		 * for its recursive calls and its sources. 'AtPosition' is whether this is the predicate the current variant of the clause reads changes through. */
+		template <typename ViewsT, MaterializePhase Phase, bool AtPosition, typename PredicateT, typename = void>
+		struct substitute_predicate
+		{
+			using type = PredicateT;
+		};
+
+		/* A recursive call reads the answers found by the previous pass if it is at the position, otherwise every answer found so far. */
+		template <typename ViewsT, MaterializePhase Phase, bool AtPosition, typename PredT, int ... ArgNs>
+		struct substitute_predicate < ViewsT, Phase, AtPosition, Satisfy<PredT, ArgNs...>,
+			std::enable_if_t<std::is_same<PredT, typename ViewsT::Self>::value> >
+		{
+			using type = Satisfy<std::conditional_t<AtPosition, typename ViewsT::Delta, typename ViewsT::Full>, ArgNs...>;
+		};
+
+		/* A source at the position reads the instances that became true (or false, when removing), otherwise the state that is current for the phase. */
+		template <typename ViewsT, MaterializePhase Phase, bool AtPosition, typename PredT, int ... ArgNs>
+		struct substitute_predicate < ViewsT, Phase, AtPosition, Satisfy<PredT, ArgNs...>,
+			std::enable_if_t<has_changes<PredT>::value && !std::is_same<PredT, typename ViewsT::Self>::value> >
+		{
+			using type = Satisfy<std::conditional_t<AtPosition,
+				std::conditional_t<Phase == MaterializePhase::Insert, typename ViewsT::template Inserted<PredT>, typename ViewsT::template Removed<PredT>>,
+				std::conditional_t<Phase == MaterializePhase::Remove, typename ViewsT::template Old<PredT>, PredT>>, ArgNs...>;
+		};
+
+		/* A negated source at the position reads the instances that became false (or true, when removing), which makes the negation become true (or false). */
+		template <typename ViewsT, MaterializePhase Phase, bool AtPosition, typename PredT, int ... ArgNs>
+		struct substitute_predicate < ViewsT, Phase, AtPosition, NotSatisfy<PredT, ArgNs...>,
+			std::enable_if_t<has_changes<PredT>::value && !std::is_same<PredT, typename ViewsT::Self>::value> >
+		{
+			using type = std::conditional_t<AtPosition,
+				Satisfy<std::conditional_t<Phase == MaterializePhase::Insert, typename ViewsT::template Removed<PredT>, typename ViewsT::template Inserted<PredT>>, ArgNs...>,
+				NotSatisfy<std::conditional_t<Phase == MaterializePhase::Remove, typename ViewsT::template Old<PredT>, PredT>, ArgNs...>>;
+		};
+
+		/* Substitutes every predicate in a clause, for the variant that reads changes through the predicate at 'Position' (or none, if -1). */
+		template <typename ViewsT, MaterializePhase Phase, int Position, typename PredicateList, typename Indices>
+		struct substitute_predicates_at;
+
+		template <typename ViewsT, MaterializePhase Phase, int Position, typename ... PredicateTs, std::size_t ... Is>
+		struct substitute_predicates_at < ViewsT, Phase, Position, tmp::type_list<PredicateTs...>, std::index_sequence<Is...> >
+		{
+			using type = tmp::type_list<typename substitute_predicate<ViewsT, Phase, Position == static_cast<int>(Is), PredicateTs>::type...>;
+		};
+
+		template <typename ViewsT, MaterializePhase Phase, int Position, typename PredicateList>
+		struct substitute_predicates;
+
+		template <typename ViewsT, MaterializePhase Phase, int Position, typename ... PredicateTs>
+		struct substitute_predicates < ViewsT, Phase, Position, tmp::type_list<PredicateTs...> >
+			: substitute_predicates_at<ViewsT, Phase, Position, tmp::type_list<PredicateTs...>, std::index_sequence_for<PredicateTs...>>
+		{
+		};
+
+		/* Evaluates to std::true_type if the given predicate negates a predicate that depends on the given rule type, std::false_type otherwise. */
+		template <typename RuleT, typename PredicateT>
+		struct negates_dependent : std::false_type
+		{
+		};
+
+		template <typename RuleT, typename PredT, int ... ArgNs>
+		struct negates_dependent < RuleT, NotSatisfy<PredT, ArgNs...> > : depends_on<PredT, RuleT>
+		{
+		};
+
+		/* Evaluates to std::true_type if the given predicate stores its answers (such as a fact type or tabled rule type), std::false_type otherwise. */
+		template <typename PredicateT, typename = void>
+		struct stores_answers : std::false_type
+		{
+		};
+
+		template <typename PredicateT>
+		struct stores_answers < PredicateT, tmp::void_t<typename PredicateT::Instance> > : std::true_type
+		{
+		};
+
+		/* Evaluates to std::true_type if any of the given predicates (other than the given rule type) depends on the given rule type,
+		 * and optionally only counting predicates that store their answers, std::false_type otherwise. */
+		template <typename RuleT, bool OnlyStored, typename PredicateList>
+		struct has_recursion;
+
+		template <typename RuleT, bool OnlyStored, typename ... PredicateTs>
+		struct has_recursion < RuleT, OnlyStored, tmp::type_list<PredicateTs...> >
+			: tmp::fold_or<false, (!std::is_same<PredicateTs, RuleT>::value && (!OnlyStored || stores_answers<PredicateTs>::value) && depends_on<PredicateTs, RuleT>::value)...>
+		{
+		};
+
+		/* The net changes made to a source of a materialized rule since the rule was last updated. */
+		template <typename SourceT>
+		struct SourceChanges
+		{
+			/* The generation of the source when the rule was last updated. */
+			std::size_t generation = 0;
+
+			typename SourceT::Changes::Store inserted;
+
+			typename SourceT::Changes::Store removed;
+		};
+
+		template <typename SourceList>
+		struct source_changes_tuple;
+
+		template <typename ... SourceTs>
+		struct source_changes_tuple < tmp::type_list<SourceTs...> >
+		{
+			using type = std::tuple<SourceChanges<SourceTs>...>;
+		};
+	}
+
+	/* Maintenance policy for 'BasicMaterializedRuleType' that updates the stored answers with the changes to the rule's sources
+	 * (by delete-and-rederive), where possible. */
+	struct IncrementalMaintenance
+	{
+		static constexpr bool incremental = true;
+	};
+
+	/* Maintenance policy for 'BasicMaterializedRuleType' that evaluates the answers from scratch whenever anything they depend on changes.
+	 * This keeps the answers in the order they are found by evaluation, which incremental maintenance does not (new answers are found last). */
+	struct FullReevaluation
+	{
+		static constexpr bool incremental = false;
+	};
+
+	/* Type defining a 'Rule Type' with clauses fixed at compile time (as with 'StaticRuleType'), whose answers are materialized.
+	 * The first call evaluates the clauses bottom-up and stores every answer in the database, and further calls are served from the
+	 * stored answers in the same way as a fact type.
+	 * Recursive clauses are evaluated with semi-naive iteration: after the first pass, each pass evaluates every recursive clause once for
+	 * each recursive call in it, with that call only using the answers found by the previous pass.
+	 * With 'IncrementalMaintenance', the stored answers are maintained when the fact types and materialized rules in the clauses (the 'sources') change,
+	 * by delete-and-rederive: answers with a derivation that used a changed instance are removed, any of those that still have a derivation are
+	 * put back, and then answers with derivations that use a changed instance are added. Each step only evaluates the clauses with one
+	 * predicate reading the changes to a source (and then to this rule), so the cost scales with the size of the changes.
+	 * If the rule is recursive through another rule, or any other rule in the clauses depends on a fact type that changed, the answers are
+	 * instead evaluated from scratch.
+	 * A materialized rule may be recursive through its own clauses, or through rules that don't store their answers (such as 'StaticRuleType').
+	 * It must not negate (with 'NotSatisfy') any rule that depends on it, so that negated rules are completely evaluated before they are used.
+	 * 'StorageT' - The policy for how answers are stored in the database (such as 'OrderedStorage<...>').
+	 * 'MaintenancePolicyT' - How answers are updated when the database changes (such as 'IncrementalMaintenance'). */
+	template <typename SelfT, typename StorageT, typename MaintenancePolicyT, typename ArgTypeList, typename ... ClauseTs>
+	struct BasicMaterializedRuleType;
+
+	template <typename SelfT, typename StorageT, typename MaintenancePolicyT, typename ... ArgTs, typename ... ClauseTs>
+	struct BasicMaterializedRuleType < SelfT, StorageT, MaintenancePolicyT, tmp::type_list<ArgTs...>, ClauseTs... >
+	{
+		using ArgTypes = tmp::type_list<ArgTs...>;
+
+		using ArgTuple = std::tuple<Var<ArgTs>*...>;
+
+		using Instance = std::tuple<ArgTs...>;
+
+		/* The list of clauses for this rule, used to find the fact types it depends on (see 'fact_dependencies'). */
+		using ClauseTypes = tmp::type_list<ClauseTs...>;
+
+		/* The type of record of changes made to the answers of this rule (see 'get_changes'). */
+		using Changes = ChangeLog<typename StorageT::template Store<ArgTs...>>;
+
+	private:
+
+		using Phase = impl::MaterializePhase;
+
+		using PredicateKind = impl::PredicateKind;
+
+		/* The type of object that stores all answers to this rule in the database. */
+		using Store = typename StorageT::template Store<ArgTs...>;
+
+		/* Every predicate type used in the clauses. */
+		using Predicates = typename impl::append_clause_predicates<ClauseTypes, tmp::type_list<>>::type;
+
+		/* The predicates in the clauses whose changes are recorded. */
+		using Sources = typename impl::collect_sources<SelfT, Predicates>::type;
+
+		struct Relation
+		{
+			/* Whether 'answers' has been evaluated. */
+			bool evaluated = false;
+
+			/* Whether the answers are currently being evaluated or maintained, in which case calls use the answers found so far. */
+			bool evaluating = false;
+
+			Store answers;
+
+			Changes changes;
+
+			/* The answers found by the previous pass, while evaluating or maintaining. */
+			const Store* delta = nullptr;
+
+			/* The changes to each source since the last update. */
+			typename impl::source_changes_tuple<Sources>::type sources;
+
+			/* The generation of the fact types depended on by predicates other than sources, at the last update. */
+			std::size_t other_generation = 0;
+		};
+
+		/* Substituted for recursive calls, to use every answer found so far. */
+		struct FullRelation
+		{
+			using ArgTypes = tmp::type_list<ArgTs...>;
+
+			using Adorned = std::true_type;
+
+			template <typename DBaseT, typename ContinueFnT>
+			static bool satisfy(const DBaseT& dataBase, ArgTuple& args, const ContinueFnT& next)
+			{
+				return get_relation(dataBase).answers.satisfy(args, next);
+			}
+
+			template <typename DBaseT, typename ContinueFnT, std::size_t Mode>
+			static bool satisfy(const DBaseT& dataBase, ArgTuple& args, const ContinueFnT& next, Adornment<Mode> mode)
+			{
+				return satisfy_store(mode, get_relation(dataBase).answers, args, next);
+			}
+		};
+
+		/* Substituted for recursive calls, to use the answers found by the previous pass. */
+		struct DeltaRelation
+		{
+			using ArgTypes = tmp::type_list<ArgTs...>;
+
+			using Adorned = std::true_type;
+
+			template <typename DBaseT, typename ContinueFnT>
+			static bool satisfy(const DBaseT& dataBase, ArgTuple& args, const ContinueFnT& next)
+			{
+				return get_relation(dataBase).delta->satisfy(args, next);
+			}
+
+			template <typename DBaseT, typename ContinueFnT, std::size_t Mode>
+			static bool satisfy(const DBaseT& dataBase, ArgTuple& args, const ContinueFnT& next, Adornment<Mode> mode)
+			{
+				return satisfy_store(mode, *get_relation(dataBase).delta, args, next);
+			}
+		};
+
+		/* Substituted for a source, to use the instances inserted since the last update. */
+		template <typename SourceT>
+		struct InsertedView
+		{
+			using ArgTypes = typename SourceT::ArgTypes;
+
+			using Adorned = std::true_type;
+
+			template <typename DBaseT, typename ArgTupleT, typename ContinueFnT>
+			static bool satisfy(const DBaseT& dataBase, ArgTupleT& args, const ContinueFnT& next)
+			{
+				return get_source_changes<SourceT>(dataBase).inserted.satisfy(args, next);
+			}
+
+			template <typename DBaseT, typename ArgTupleT, typename ContinueFnT, std::size_t Mode>
+			static bool satisfy(const DBaseT& dataBase, ArgTupleT& args, const ContinueFnT& next, Adornment<Mode> mode)
+			{
+				return satisfy_store(mode, get_source_changes<SourceT>(dataBase).inserted, args, next);
+			}
+		};
+
+		/* Substituted for a source, to use the instances removed since the last update. */
+		template <typename SourceT>
+		struct RemovedView
+		{
+			using ArgTypes = typename SourceT::ArgTypes;
+
+			using Adorned = std::true_type;
+
+			template <typename DBaseT, typename ArgTupleT, typename ContinueFnT>
+			static bool satisfy(const DBaseT& dataBase, ArgTupleT& args, const ContinueFnT& next)
+			{
+				return get_source_changes<SourceT>(dataBase).removed.satisfy(args, next);
+			}
+
+			template <typename DBaseT, typename ArgTupleT, typename ContinueFnT, std::size_t Mode>
+			static bool satisfy(const DBaseT& dataBase, ArgTupleT& args, const ContinueFnT& next, Adornment<Mode> mode)
+			{
+				return satisfy_store(mode, get_source_changes<SourceT>(dataBase).removed, args, next);
+			}
+		};
+
+		/* Substituted for a source, to use its instances as they were at the last update. */
+		template <typename SourceT>
+		struct OldView
+		{
+			using ArgTypes = typename SourceT::ArgTypes;
+
+			template <typename DBaseT, typename ArgTupleT, typename ContinueFnT>
+			static bool satisfy(const DBaseT& dataBase, ArgTupleT& args, const ContinueFnT& next)
+			{
+				const auto& changes = get_source_changes<SourceT>(dataBase);
+
+				// Skip the current instances that were inserted since then, and add the ones that were removed
+				return SourceT::satisfy(dataBase, args, [&]() -> bool
+				{
+					if (changes.inserted.contains(arg_pack_values(args)))
+					{
+						return false;
+					}
+
+					return next();
+				}) || changes.removed.satisfy(args, next);
+			}
+		};
+
+		struct Views
+		{
+			using Self = SelfT;
+
+			using Full = FullRelation;
+
+			using Delta = DeltaRelation;
+
+			template <typename SourceT>
+			using Inserted = InsertedView<SourceT>;
+
+			template <typename SourceT>
+			using Removed = RemovedView<SourceT>;
+
+			template <typename SourceT>
+			using Old = OldView<SourceT>;
+		};
+
+		///////////////////
+		///   Methods   ///
+	public:
+
+		/* Materialized rule types pass their 'Adornment' on to the store of their answers, if it is adorned. */
+		using Adorned = std::true_type;
+
+		template <typename DBaseT, typename ContinueFnT>
+		static bool satisfy(const DBaseT& dataBase, ArgTuple& args, const ContinueFnT& next)
+		{
+			return update(dataBase).answers.satisfy(args, next);
+		}
+
+		template <typename DBaseT, typename ContinueFnT, std::size_t Mode>
+		static bool satisfy(const DBaseT& dataBase, ArgTuple& args, const ContinueFnT& next, Adornment<Mode> mode)
+		{
+			return satisfy_store(mode, update(dataBase).answers, args, next);
+		}
+
+		/* Returns the record of changes made to the answers of this rule in the database (see 'ChangeLog'), after bringing them up to date. */
+		template <typename DBaseT>
+		static const Changes& get_changes(const DBaseT& dataBase)
+		{
+			return update(dataBase).changes;
+		}
+
+	private:
+
+		template <typename DBaseT>
+		static Relation& get_relation(const DBaseT& dataBase)
+		{
+			return dataBase.template get_rule_cache<SelfT, Relation>();
+		}
+
+		template <typename SourceT, typename DBaseT>
+		static impl::SourceChanges<SourceT>& get_source_changes(const DBaseT& dataBase)
+		{
+			return std::get<impl::SourceChanges<SourceT>>(get_relation(dataBase).sources);
+		}
+
+		/* Brings the answers up to date with the database, unless this is a recursive call made while doing so. */
+		template <typename DBaseT>
+		static Relation& update(const DBaseT& dataBase)
+		{
+			static_assert(!impl::has_recursion<SelfT, true, typename predicate_dependencies<SelfT>::type>::value,
+				"A materialized rule may not be recursive through rules that store their answers.");
+
+			auto& relation = get_relation(dataBase);
+			if (relation.evaluating)
+			{
+				return relation;
+			}
+
+			const auto otherGeneration = get_other_generation(dataBase, Predicates{});
+			const bool otherChanged = !relation.evaluated || relation.other_generation != otherGeneration;
+
+			// Getting the changes of each source also brings it up to date
+			if (!otherChanged && !sources_changed(dataBase, relation, Sources{}))
+			{
+				return relation;
+			}
+
+			// If the update is interrupted by an exception the answers are left incomplete, so they're evaluated from scratch next time
+			// (and so are those of any materialized rule reading their changes)
+			struct EvaluatingGuard
+			{
+				~EvaluatingGuard()
+				{
+					relation.evaluating = false;
+					if (!finished)
+					{
+						relation.evaluated = false;
+						relation.changes.invalidate();
+					}
+				}
+
+				Relation& relation;
+				bool finished;
+			} guard{ relation, false };
+			relation.evaluating = true;
+
+			if (otherChanged || !maintainable() || !source_changes_kept(dataBase, relation, Sources{}))
+			{
+				evaluate(dataBase, relation);
+			}
+			else
+			{
+				load_source_changes(dataBase, relation, Sources{});
+				maintain(dataBase, relation);
+			}
+
+			store_source_generations(dataBase, relation, Sources{});
+			relation.other_generation = otherGeneration;
+			relation.evaluated = true;
+			guard.finished = true;
+
+			return relation;
+		}
+
+		/* Returns whether the answers may be maintained incrementally, rather than evaluated from scratch.
+		 * Rules that are recursive through other rules can't find the changes to their answers through those rules. */
+		static constexpr bool maintainable()
+		{
+			return MaintenancePolicyT::incremental && !impl::has_recursion<SelfT, false, Predicates>::value;
+		}
+
+		/* Returns the sum of the generations of the fact types depended on by the predicates that aren't sources. */
+		template <typename DBaseT, typename ... PredTs>
+		static std::size_t get_other_generation(const DBaseT& dataBase, tmp::type_list<PredTs...>)
+		{
+			std::size_t result = 0;
+
+			using swallow = int[];
+			(void)swallow{ 0, (result += impl::has_changes<PredTs>::value || std::is_same<PredTs, SelfT>::value
+				? 0
+				: get_generation(dataBase, typename fact_dependencies<PredTs>::type{}), 0)... };
+
+			return result;
+		}
+
+		template <typename DBaseT, typename ... SourceTs>
+		static bool sources_changed(const DBaseT& dataBase, Relation& relation, tmp::type_list<SourceTs...>)
+		{
+			bool changed = false;
+
+			using swallow = int[];
+			(void)swallow{ 0, (changed |= SourceTs::get_changes(dataBase).generation() != std::get<impl::SourceChanges<SourceTs>>(relation.sources).generation, 0)... };
+
+			return changed;
+		}
+
+		/* Returns whether every source still keeps its changes since the last update (see 'ChangeLog::has_changes_since'). */
+		template <typename DBaseT, typename ... SourceTs>
+		static bool source_changes_kept(const DBaseT& dataBase, Relation& relation, tmp::type_list<SourceTs...>)
+		{
+			bool kept = true;
+
+			using swallow = int[];
+			(void)swallow{ 0, (kept &= SourceTs::get_changes(dataBase).has_changes_since(std::get<impl::SourceChanges<SourceTs>>(relation.sources).generation), 0)... };
+
+			return kept;
+		}
+
+		/* Finds the net changes to each source since the last update. */
+		template <typename DBaseT, typename ... SourceTs>
+		static void load_source_changes(const DBaseT& dataBase, Relation& relation, tmp::type_list<SourceTs...>)
+		{
+			using swallow = int[];
+			(void)swallow{ 0, (SourceTs::get_changes(dataBase).get_changes(
+				std::get<impl::SourceChanges<SourceTs>>(relation.sources).generation,
+				std::get<impl::SourceChanges<SourceTs>>(relation.sources).inserted,
+				std::get<impl::SourceChanges<SourceTs>>(relation.sources).removed), 0)... };
+		}
+
+		/* Records the current generation of each source, and discards the changes found for the last update.
+		 * If the answers are maintained incrementally this subscribes to the changes of each source from then on, otherwise the changes
+		 * are never read so they aren't kept. */
+		template <typename DBaseT, typename ... SourceTs>
+		static void store_source_generations(const DBaseT& dataBase, Relation& relation, tmp::type_list<SourceTs...>)
+		{
+			using swallow = int[];
+			(void)swallow{ 0, (std::get<impl::SourceChanges<SourceTs>>(relation.sources) = impl::SourceChanges<SourceTs>(),
+				std::get<impl::SourceChanges<SourceTs>>(relation.sources).generation = maintainable()
+					? SourceTs::get_changes(dataBase).subscribe(&relation)
+					: SourceTs::get_changes(dataBase).generation(), 0)... };
+		}
+
+		/* Finds every answer to this rule from scratch, recording how they differ from the previous answers. */
+		template <typename DBaseT>
+		static void evaluate(const DBaseT& dataBase, Relation& relation)
+		{
+			auto previous = std::move(relation.answers);
+			relation.answers = Store();
+
+			run_passes<Phase::Evaluate>(dataBase, relation,
+				[&](const Instance& answer)
+				{
+					return !relation.answers.contains(answer);
+				},
+				[&](const Instance& answer)
+				{
+					relation.answers.insert(answer);
+
+					if (!previous.contains(answer))
+					{
+						relation.changes.push(answer, true);
+					}
+				});
+
+			for_each_instance(previous, [&](const Instance& answer)
+			{
+				if (!relation.answers.contains(answer))
+				{
+					relation.changes.push(answer, false);
+				}
+			});
+		}
+
+		/* Updates the answers to this rule with the changes to its sources, by delete-and-rederive. */
+		template <typename DBaseT>
+		static void maintain(const DBaseT& dataBase, Relation& relation)
+		{
+			// Find every answer with a derivation that used an instance that changed (before the changes)
+			Store removed;
+			std::vector<Instance> removedList;
+			run_passes<Phase::Remove>(dataBase, relation,
+				[&](const Instance& answer)
+				{
+					return relation.answers.contains(answer) && !removed.contains(answer);
+				},
+				[&](const Instance& answer)
+				{
+					removed.insert(answer);
+					removedList.push_back(answer);
+				});
+
+			for (const auto& answer : removedList)
+			{
+				relation.answers.remove(answer);
+			}
+
+			// Put back the answers that still have a derivation (which may depend on other answers that are put back)
+			bool rederived = true;
+			while (rederived)
+			{
+				rederived = false;
+
+				for (const auto& answer : removedList)
+				{
+					if (!relation.answers.contains(answer) && derive(dataBase, answer))
+					{
+						relation.answers.insert(answer);
+						rederived = true;
+					}
+				}
+			}
+
+			for (const auto& answer : removedList)
+			{
+				if (!relation.answers.contains(answer))
+				{
+					relation.changes.push(answer, false);
+				}
+			}
+
+			// Find every answer with a derivation that uses an instance that changed
+			run_passes<Phase::Insert>(dataBase, relation,
+				[&](const Instance& answer)
+				{
+					return !relation.answers.contains(answer);
+				},
+				[&](const Instance& answer)
+				{
+					relation.answers.insert(answer);
+					relation.changes.push(answer, true);
+				});
+		}
+
+		/* Evaluates the clauses for the given phase until a pass finds no new answers. Each answer found that 'accept' returns true for
+		 * is passed to 'commit' at the end of the pass, and is read by recursive calls during the next pass. */
+		template <Phase PhaseV, typename DBaseT, typename AcceptFnT, typename CommitFnT>
+		static void run_passes(const DBaseT& dataBase, Relation& relation, const AcceptFnT& accept, const CommitFnT& commit)
+		{
+			// Answers found by the current pass, which are only committed once the pass is finished
+			Store found;
+			std::vector<Instance> foundList;
+			auto add = [&](const Instance& answer)
+			{
+				if (accept(answer) && !found.contains(answer))
+				{
+					found.insert(answer);
+					foundList.push_back(answer);
+				}
+			};
+
+			bool firstPass = true;
+			Store delta;
+
+			while (true)
+			{
+				using swallow = int[];
+				(void)swallow{ 0, (evaluate_clause_pass<PhaseV>(ClauseTs{}, firstPass, dataBase, add), 0)... };
+
+				if (foundList.empty())
+				{
+					break;
+				}
+
+				for (const auto& answer : foundList)
+				{
+					commit(answer);
+				}
+
+				// The answers found by this pass are used by the next
+				foundList.clear();
+				delta = std::move(found);
+				found = Store();
+				relation.delta = &delta;
+				firstPass = false;
+			}
+
+			relation.delta = nullptr;
+		}
+
+		/* Evaluates the given clause for a single pass of the given phase. */
+		template <Phase PhaseV, typename Params, typename ... PredicateTs, typename DBaseT, typename AddFnT>
+		static void evaluate_clause_pass(Clause<Params, PredicateTs...>, bool firstPass, const DBaseT& dataBase, const AddFnT& add)
+		{
+			using ClausePredicates = tmp::type_list<PredicateTs...>;
+
+			static_assert(!tmp::fold_or<false, impl::negates_dependent<SelfT, PredicateTs>::value...>::value,
+				"A materialized rule may not negate a rule that depends on it.");
+
+			constexpr bool recursive = tmp::fold_or<false, impl::predicate_kind<SelfT, PredicateTs>::value == PredicateKind::Self...>::value;
+			constexpr bool indirect = tmp::fold_or<false, (impl::predicate_kind<SelfT, PredicateTs>::value != PredicateKind::Self &&
+				depends_on<typename impl::predicate_type<PredicateTs>::type, SelfT>::value)...>::value;
+
+			if (PhaseV == Phase::Evaluate && firstPass)
+			{
+				// Clauses that call this rule directly can't find anything until there are answers from other clauses
+				if (!recursive || indirect)
+				{
+					evaluate_clause(Params{}, typename impl::substitute_predicates<Views, PhaseV, -1, ClausePredicates>::type{}, dataBase, add);
+				}
+			}
+			else if (PhaseV == Phase::Evaluate && indirect)
+			{
+				// Calls through other rules can't be limited to the previous pass's answers, so the whole clause is evaluated again
+				evaluate_clause(Params{}, typename impl::substitute_predicates<Views, PhaseV, -1, ClausePredicates>::type{}, dataBase, add);
+			}
+			else
+			{
+				// The first pass of maintenance reads the changes to each source, and later passes read the changes to this rule
+				if (firstPass)
+				{
+					evaluate_clause_variants<PhaseV, PredicateKind::Source>(Params{}, ClausePredicates{}, std::index_sequence_for<PredicateTs...>{}, dataBase, add);
+				}
+				else
+				{
+					evaluate_clause_variants<PhaseV, PredicateKind::Self>(Params{}, ClausePredicates{}, std::index_sequence_for<PredicateTs...>{}, dataBase, add);
+				}
+			}
+		}
+
+		/* Evaluates the given clause once for each predicate of the given kind in it, with that predicate reading changes. */
+		template <Phase PhaseV, PredicateKind KindV, typename Params, typename ... PredicateTs, std::size_t ... Is, typename DBaseT, typename AddFnT>
+		static void evaluate_clause_variants(Params params, tmp::type_list<PredicateTs...> predicates, std::index_sequence<Is...>, const DBaseT& dataBase, const AddFnT& add)
+		{
+			using swallow = int[];
+			(void)swallow{ 0, (evaluate_clause_variant<PhaseV, static_cast<int>(Is)>(params, predicates, PredicateTs{},
+				std::integral_constant<bool, impl::predicate_kind<SelfT, PredicateTs>::value == KindV>{}, dataBase, add), 0)... };
+		}
+
+		/* Evaluates the variant of the given clause that reads changes through the predicate at 'Position'. */
+		template <Phase PhaseV, int Position, typename Params, typename ClausePredicates, typename PredicateT, typename DBaseT, typename AddFnT>
+		static void evaluate_clause_variant(Params params, ClausePredicates, PredicateT predicate, std::true_type, const DBaseT& dataBase, const AddFnT& add)
+		{
+			// Don't bother if there are no changes to read
+			if (has_changes_at(predicate, dataBase))
+			{
+				evaluate_clause(params, typename impl::substitute_predicates<Views, PhaseV, Position, ClausePredicates>::type{}, dataBase, add);
+			}
+		}
+
+		template <Phase PhaseV, int Position, typename Params, typename ClausePredicates, typename PredicateT, typename DBaseT, typename AddFnT>
+		static void evaluate_clause_variant(Params, ClausePredicates, PredicateT, std::false_type, const DBaseT&, const AddFnT&)
+		{
+		}
+
+		template <typename PredT, int ... ArgNs, typename DBaseT>
+		static bool has_changes_at(Satisfy<PredT, ArgNs...>, const DBaseT& dataBase)
+		{
+			return has_changes_at<PredT>(dataBase);
+		}
+
+		template <typename PredT, int ... ArgNs, typename DBaseT>
+		static bool has_changes_at(NotSatisfy<PredT, ArgNs...>, const DBaseT& dataBase)
+		{
+			return has_changes_at<PredT>(dataBase);
+		}
+
+		template <typename PredT, typename DBaseT>
+		static auto has_changes_at(const DBaseT& dataBase) -> std::enable_if_t<std::is_same<PredT, SelfT>::value, bool>
+		{
+			return get_relation(dataBase).delta->size() != 0;
+		}
+
+		template <typename PredT, typename DBaseT>
+		static auto has_changes_at(const DBaseT& dataBase) -> std::enable_if_t<!std::is_same<PredT, SelfT>::value, bool>
+		{
+			const auto& changes = get_source_changes<PredT>(dataBase);
+			return changes.inserted.size() != 0 || changes.removed.size() != 0;
+		}
+
+		/* Evaluates a clause with the given parameters and predicates with every argument unbound, passing each answer to 'add'. */
+		template <typename Params, typename ... PredicateTs, typename DBaseT, typename AddFnT>
+		static void evaluate_clause(Params, tmp::type_list<PredicateTs...>, const DBaseT& dataBase, const AddFnT& add)
+		{
+			std::tuple<StoredVarChainElement<ArgTs, 0>...> vars;
+			auto args = get_arg_tuple(vars, std::index_sequence_for<ArgTs...>{});
+
+			Rule<SelfT, Params, PredicateTs...>::template satisfy<DBaseT>(dataBase, args, [&]() -> bool
+			{
+				add(arg_pack_values(args));
+				return false;
+			});
+		}
+
+		/* Returns whether the given answer has a derivation from the current state of the database (and the current answers). */
+		template <typename DBaseT>
+		static bool derive(const DBaseT& dataBase, const Instance& answer)
+		{
+			bool derived = false;
+
+			using swallow = int[];
+			(void)swallow{ 0, (derived = derived || derive_clause(ClauseTs{}, dataBase, answer), 0)... };
+
+			return derived;
+		}
+
+		template <typename Params, typename ... PredicateTs, typename DBaseT>
+		static bool derive_clause(Clause<Params, PredicateTs...>, const DBaseT& dataBase, const Instance& answer)
+		{
+			std::tuple<StoredVarChainElement<ArgTs, 0>...> vars;
+			set_values(vars, answer, std::index_sequence_for<ArgTs...>{});
+			auto args = get_arg_tuple(vars, std::index_sequence_for<ArgTs...>{});
+
+			return derive_clause(Params{}, typename impl::substitute_predicates<Views, Phase::Evaluate, -1, tmp::type_list<PredicateTs...>>::type{}, dataBase, args);
+		}
+
+		template <typename Params, typename ... PredicateTs, typename DBaseT>
+		static bool derive_clause(Params, tmp::type_list<PredicateTs...>, const DBaseT& dataBase, ArgTuple& args)
+		{
+			// One derivation is enough, so stop at the first
+			return Rule<SelfT, Params, PredicateTs...>::template satisfy<DBaseT>(dataBase, args, []() -> bool
+			{
+				return true;
+			});
+		}
+
+		/* Calls the given function with every instance in the given store. */
+		template <typename FnT>
+		static void for_each_instance(const Store& store, const FnT& fn)
+		{
+			std::tuple<StoredVarChainElement<ArgTs, 0>...> vars;
+			auto args = get_arg_tuple(vars, std::index_sequence_for<ArgTs...>{});
+
+			store.satisfy(args, [&]() -> bool
+			{
+				fn(arg_pack_values(args));
+				return false;
+			});
+		}
+
+		template <typename VarTupleT, std::size_t ... Is>
+		static ArgTuple get_arg_tuple(VarTupleT& vars, std::index_sequence<Is...>)
+		{
+			return ArgTuple(&std::get<Is>(vars)...);
+		}
+
+		template <typename VarTupleT, std::size_t ... Is>
+		static void set_values(VarTupleT& vars, const Instance& values, std::index_sequence<Is...>)
+		{
+			using swallow = int[];
+			(void)swallow{ 0, (std::get<Is>(vars).set_value(std::get<Is>(values)), 0)... };
+		}
+	};
+
+	/* Materialized rule type (see 'BasicMaterializedRuleType') whose answers are maintained incrementally. */
+	template <typename SelfT, typename StorageT, typename ArgTypeList, typename ... ClauseTs>
+	using MaterializedRuleType = BasicMaterializedRuleType<SelfT, StorageT, IncrementalMaintenance, ArgTypeList, ClauseTs...>;
+}
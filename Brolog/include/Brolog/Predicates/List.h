@@ -28,10 +28,9 @@ namespace brolog
 				return next();
 			}
 
+			ChoicePoint choicePoint;
 			a->unify(std::vector<T>{});
-			bool satisfied = next();
-			a->unbind();
-			return satisfied;
+			return next();
 		}
 	};
 
@@ -64,15 +63,17 @@ namespace brolog
 			}
 
 			// A has not been unified, so just bind it to every member of B
-			bool satisfied = false;
 			for (const auto& element : b->value())
 			{
+				ChoicePoint choicePoint;
 				a->unify(element);
-				satisfied |= next();
-				a->unbind();
+				if (next())
+				{
+					return true;
+				}
 			}
 
-			return satisfied;
+			return false;
 		}
 	};
 
@@ -130,10 +131,9 @@ namespace brolog
 					else
 					{
 						// Unify b with the first element of a
+						ChoicePoint choicePoint;
 						b->unify(a->value().front());
-						bool satisfied = next();
-						b->unbind();
-						return satisfied;
+						return next();
 					}
 				}
 				else
@@ -148,23 +148,16 @@ namespace brolog
 					}
 
 					// Unify c with the value we created
+					ChoicePoint choicePoint;
 					c->unify(value);
 
 					// If b has been unified
-					bool satisfied = false;
 					if (b->unified())
 					{
 						b->unify(a->value().front());
-						satisfied = next();
-						b->unbind();
-					}
-					else
-					{
-						satisfied = next();
 					}
 
-					c->unbind();
-					return satisfied;
+					return next();
 				}
 			}
 			else
@@ -186,10 +179,9 @@ namespace brolog
 				}
 
 				// Unify a with the value we created
+				ChoicePoint choicePoint;
 				a->unify(value);
-				auto satisfied = next();
-				a->unbind();
-				return satisfied;
+				return next();
 			}
 		}
 	};
@@ -10,66 +10,95 @@ namespace brolog
 	{
 		using ArgTypes = tmp::type_list<T, T, T>;
 
+		/* 'Sum' may be called with an 'Adornment', which selects the direction to compute in at compile time. */
+		using Adorned = std::true_type;
+
+		/* 'Sum' computes its answer when at least two of its arguments are unified, so it may be moved before predicates that unify the
+		 * third (see 'impl::enumerates'). */
+		template <std::size_t Mode>
+		using Enumerates = std::integral_constant<bool, ((Mode & 0x1) != 0) + ((Mode & 0x2) != 0) + ((Mode & 0x4) != 0) >= 2>;
+
+		using ArgTuple = std::tuple<Var<T>*, Var<T>*, Var<T>*>;
+
 		template <typename DBaseT, typename ContinueFnT>
-		static bool satisfy(const DBaseT& /*dbase*/, const std::tuple<Var<T>*, Var<T>*, Var<T>*>& args, const ContinueFnT& next)
+		static bool satisfy(const DBaseT& dbase, const ArgTuple& args, const ContinueFnT& next)
 		{
-			auto* a = std::get<0>(args);
-			auto* b = std::get<1>(args);
-			auto* c = std::get<2>(args);
-
-			// If a is not unified
-			if (!a->unified())
+			// Choose the direction to compute in from the arguments that are unified
+			switch (arg_pack_unified_mask<0>(args))
 			{
-				// Try to unify a with b and c
-				if (!b->unified() || !c->unified())
-				{
-					return false;
-				}
-
-				a->unify(b->value() + c->value());
-				bool satisfied = next();
-				a->unbind();
-				return satisfied;
-			}
+			case 0x7:
+				return satisfy(dbase, args, next, Adornment<0x7>{});
 
-			// If b has not been unified
-			if (!b->unified())
-			{
-				// Try to unify b with a and c
-				if (!a->unified() || !c->unified())
-				{
-					return false;
-				}
-
-				b->unify(a->value() - c->value());
-				bool satisfied = next();
-				b->unbind();
-				return satisfied;
-			}
+			case 0x6:
+				return satisfy(dbase, args, next, Adornment<0x6>{});
 
-			// If c has not been unified
-			if (!c->unified())
-			{
-				// Try to unify c with a and b
-				if (!a->unified() || !b->unified())
-				{
-					return false;
-				}
-
-				c->unify(a->value() - c->value());
-				bool satisfied = next();
-				c->unbind();
-				return satisfied;
+			case 0x5:
+				return satisfy(dbase, args, next, Adornment<0x5>{});
+
+			case 0x3:
+				return satisfy(dbase, args, next, Adornment<0x3>{});
+
+			default:
+				return false;
 			}
+		}
 
-			// They've all been unified, make sure the sum is correct
-			if (a->value() == b->value() + c->value())
+		/* At least two of the arguments must be unified to compute the third. Fewer are known to be unified at compile time, but others
+		 * may be at runtime if they're aliased with one that is, so check which are. */
+		template <typename DBaseT, typename ContinueFnT, std::size_t Mode>
+		static bool satisfy(const DBaseT& dbase, const ArgTuple& args, const ContinueFnT& next, Adornment<Mode>)
+		{
+			return satisfy(dbase, args, next);
+		}
+
+		/* They've all been unified, make sure the sum is correct. */
+		template <typename DBaseT, typename ContinueFnT>
+		static bool satisfy(const DBaseT& /*dbase*/, const ArgTuple& args, const ContinueFnT& next, Adornment<0x7>)
+		{
+			if (std::get<0>(args)->value() == std::get<1>(args)->value() + std::get<2>(args)->value())
 			{
 				return next();
 			}
 
 			return false;
 		}
+
+		/* Unify a with b and c. */
+		template <typename DBaseT, typename ContinueFnT>
+		static bool satisfy(const DBaseT& /*dbase*/, const ArgTuple& args, const ContinueFnT& next, Adornment<0x6>)
+		{
+			return unify_result(*std::get<0>(args), std::get<1>(args)->value() + std::get<2>(args)->value(), next);
+		}
+
+		/* Unify b with a and c. */
+		template <typename DBaseT, typename ContinueFnT>
+		static bool satisfy(const DBaseT& /*dbase*/, const ArgTuple& args, const ContinueFnT& next, Adornment<0x5>)
+		{
+			return unify_result(*std::get<1>(args), std::get<0>(args)->value() - std::get<2>(args)->value(), next);
+		}
+
+		/* Unify c with a and b. */
+		template <typename DBaseT, typename ContinueFnT>
+		static bool satisfy(const DBaseT& /*dbase*/, const ArgTuple& args, const ContinueFnT& next, Adornment<0x3>)
+		{
+			return unify_result(*std::get<2>(args), std::get<0>(args)->value() - std::get<1>(args)->value(), next);
+		}
+
+	private:
+
+		/* Unifies the argument being computed with its value. It may already be unified if it is aliased with another argument. */
+		template <typename ContinueFnT>
+		static bool unify_result(Var<T>& arg, const T& value, const ContinueFnT& next)
+		{
+			if (arg.unified())
+			{
+				return arg.value() == value && next();
+			}
+
+			ChoicePoint choicePoint;
+			arg.unify(value);
+			return next();
+		}
 	};
 
 	template <typename T, T V>
@@ -77,15 +106,31 @@ namespace brolog
 	{
 		using ArgTypes = tmp::type_list<T, T>;
 
+		using Adorned = std::true_type;
+
+		/* The constant is the third argument of 'Sum', so one unified argument is enough. */
+		template <std::size_t Mode>
+		using Enumerates = typename Sum<T>::template Enumerates<Mode | 0x4>;
+
 		template <typename DBaseT, typename ContinueFnT>
 		static bool satisfy(const DBaseT& dbase, const std::tuple<Var<T>*, Var<T>*>& args, const ContinueFnT& next)
 		{
 			// Create a third argument and unify it with the constant
 			StoredVarChainElement<T, std::numeric_limits<int>::max()> c;
-			c.unify(V);
+			c.set_value(V);
 
 			return Sum<T>::satisfy(dbase, std::make_tuple(std::get<0>(args), std::get<1>(args), &c), next);
 		}
+
+		template <typename DBaseT, typename ContinueFnT, std::size_t Mode>
+		static bool satisfy(const DBaseT& dbase, const std::tuple<Var<T>*, Var<T>*>& args, const ContinueFnT& next, Adornment<Mode>)
+		{
+			// Same as above, but the third argument is known to be unified
+			StoredVarChainElement<T, std::numeric_limits<int>::max()> c;
+			c.set_value(V);
+
+			return Sum<T>::satisfy(dbase, std::make_tuple(std::get<0>(args), std::get<1>(args), &c), next, Adornment<Mode | 0x4>{});
+		}
 	};
 
 	template <typename T>
@@ -0,0 +1,589 @@
+// Reorder.h - Copyright (c) 2016 Will Cassella
+#pragma once
+
+#include "Adornment.h"
+#include "TMP.h"
+#include "VarChain.h"
+
+namespace brolog
+{
+	template <typename CookieT, typename ... ArgTs>
+	struct RuleType;
+
+	template <typename PredicateT, int ... ArgNs>
+	struct Satisfy;
+
+	template <typename PredicateT, int ... ArgNs>
+	struct NotSatisfy;
+
+	template <typename PredT, std::size_t KeyMask>
+	struct Distinct;
+
+	template <typename Params, typename ... PredicateTs>
+	struct Clause;
+
+	namespace impl
+	{
+		/* Evaluates to the given set of var names (an int_list) with the given name added, unless it is already there or is 'ANONYMOUS'.
+		 * Constants (see 'Const') are never added, since they're always unified. */
+		template <typename Set, int N>
+		struct set_insert;
+
+		template <int ... Ns, int N>
+		struct set_insert < tmp::int_list<Ns...>, N >
+			: std::conditional<N == ANONYMOUS || is_constant_name<N>::value || tmp::element_of_int_list<N, tmp::int_list<Ns...>>::value,
+				tmp::int_list<Ns...>, tmp::int_list<Ns..., N>>
+		{
+		};
+
+		/* Evaluates to the given set of var names with every name in the given int_list added. */
+		template <typename Set, typename List>
+		struct set_union;
+
+		template <typename Set>
+		struct set_union < Set, tmp::int_list<> >
+		{
+			using type = Set;
+		};
+
+		template <typename Set, int N, int ... Ns>
+		struct set_union < Set, tmp::int_list<N, Ns...> > : set_union<typename set_insert<Set, N>::type, tmp::int_list<Ns...>>
+		{
+		};
+
+		/* Evaluates to the set of var names in the given int_list that are also in the given set. */
+		template <typename List, typename Set, typename Result = tmp::int_list<>>
+		struct set_intersection;
+
+		template <typename Set, typename Result>
+		struct set_intersection < tmp::int_list<>, Set, Result >
+		{
+			using type = Result;
+		};
+
+		template <int N, int ... Ns, typename Set, typename Result>
+		struct set_intersection < tmp::int_list<N, Ns...>, Set, Result >
+			: set_intersection<tmp::int_list<Ns...>, Set,
+				std::conditional_t<tmp::element_of_int_list<N, Set>::value, typename set_insert<Result, N>::type, Result>>
+		{
+		};
+
+		/* Evaluates to the number of names in the given set that are not in the other given set. */
+		template <typename Set, typename OtherSet>
+		struct count_missing;
+
+		template <typename OtherSet>
+		struct count_missing < tmp::int_list<>, OtherSet > : std::integral_constant<std::size_t, 0>
+		{
+		};
+
+		template <int N, int ... Ns, typename OtherSet>
+		struct count_missing < tmp::int_list<N, Ns...>, OtherSet >
+			: std::integral_constant<std::size_t, (tmp::element_of_int_list<N, OtherSet>::value ? 0 : 1) + count_missing<tmp::int_list<Ns...>, OtherSet>::value>
+		{
+		};
+
+		/* Evaluates to the set of names at the positions of the given names that are set in the given mask. */
+		template <typename Names, std::size_t Mask, std::size_t I = 0, typename Result = tmp::int_list<>>
+		struct mask_names;
+
+		template <std::size_t Mask, std::size_t I, typename Result>
+		struct mask_names < tmp::int_list<>, Mask, I, Result >
+		{
+			using type = Result;
+		};
+
+		template <int N, int ... Ns, std::size_t Mask, std::size_t I, typename Result>
+		struct mask_names < tmp::int_list<N, Ns...>, Mask, I, Result >
+			: mask_names<tmp::int_list<Ns...>, Mask, I + 1, std::conditional_t<(Mask & (std::size_t{ 1 } << I)) != 0, typename set_insert<Result, N>::type, Result>>
+		{
+		};
+
+		/* Evaluates to the set of var names a "Satisfy<...>" or "NotSatisfy<...>" refers to (excluding anonymous arguments). */
+		template <typename PredicateT>
+		struct predicate_names;
+
+		template <typename PredT, int ... ArgNs>
+		struct predicate_names < Satisfy<PredT, ArgNs...> > : set_union<tmp::int_list<>, tmp::int_list<ArgNs...>>
+		{
+		};
+
+		template <typename PredT, int ... ArgNs>
+		struct predicate_names < NotSatisfy<PredT, ArgNs...> > : set_union<tmp::int_list<>, tmp::int_list<ArgNs...>>
+		{
+		};
+
+		/* Evaluates to the set of var names unified by the positive predicates ("Satisfy<...>") in the given type_list. */
+		template <typename PredicateList, typename Result = tmp::int_list<>>
+		struct satisfied_names;
+
+		template <typename Result>
+		struct satisfied_names < tmp::type_list<>, Result >
+		{
+			using type = Result;
+		};
+
+		template <typename PredT, int ... ArgNs, typename ... PredicateTs, typename Result>
+		struct satisfied_names < tmp::type_list<Satisfy<PredT, ArgNs...>, PredicateTs...>, Result >
+			: satisfied_names<tmp::type_list<PredicateTs...>, typename set_union<Result, tmp::int_list<ArgNs...>>::type>
+		{
+		};
+
+		template <typename PredT, int ... ArgNs, typename ... PredicateTs, typename Result>
+		struct satisfied_names < tmp::type_list<NotSatisfy<PredT, ArgNs...>, PredicateTs...>, Result >
+			: satisfied_names<tmp::type_list<PredicateTs...>, Result>
+		{
+		};
+
+		template <typename PredT, typename = void>
+		struct has_store : std::false_type
+		{
+		};
+
+		template <typename PredT>
+		struct has_store < PredT, tmp::void_t<typename PredT::Store> > : std::true_type
+		{
+		};
+
+		template <typename PredT, typename = void>
+		struct has_clauses : std::false_type
+		{
+		};
+
+		template <typename PredT>
+		struct has_clauses < PredT, tmp::void_t<typename PredT::ClauseTypes> > : std::true_type
+		{
+		};
+
+		/* Evaluates to std::true_type if the given predicate type is a relation (a fact type or rule type) that may enumerate many answers,
+		 * std::false_type if it is a built-in (such as 'Sum') that computes its answers from its arguments. */
+		template <typename PredT>
+		struct is_relation : std::integral_constant<bool, has_store<PredT>::value || has_clauses<PredT>::value>
+		{
+		};
+
+		template <typename CookieT, typename ... ArgTs>
+		struct is_relation < RuleType<CookieT, ArgTs...> > : std::true_type
+		{
+		};
+
+		template <typename PredT, std::size_t KeyMask>
+		struct is_relation < Distinct<PredT, KeyMask> > : std::true_type
+		{
+		};
+
+		/* Evaluates to the mask of the given parameters that are constants or in the given set of names. */
+		template <typename Params, typename Names, std::size_t I = 0>
+		struct names_mask;
+
+		template <typename Names, std::size_t I>
+		struct names_mask < tmp::int_list<>, Names, I > : std::integral_constant<std::size_t, 0>
+		{
+		};
+
+		template <int N, int ... Ns, typename Names, std::size_t I>
+		struct names_mask < tmp::int_list<N, Ns...>, Names, I >
+			: std::integral_constant<std::size_t,
+				(is_constant_name<N>::value || tmp::element_of_int_list<N, Names>::value ? std::size_t{ 1 } << I : 0) | names_mask<tmp::int_list<Ns...>, Names, I + 1>::value>
+		{
+		};
+
+		/* Evaluates to the mask of the arguments every one of the given clauses unifies when it succeeds with the given adornment: those
+		 * whose parameters are constants, were unified on entry (including through another parameter with the same name), or are given to one
+		 * of the clause's "Satisfy<...>" predicates. Since rules may be recursive, a rule called by the clause is taken to unify all of its
+		 * arguments, rather than following its own clauses. */
+		template <std::size_t Mode, typename ClauseList>
+		struct clauses_unified_mask;
+
+		template <std::size_t Mode>
+		struct clauses_unified_mask < Mode, tmp::type_list<> > : std::integral_constant<std::size_t, ~std::size_t{ 0 }>
+		{
+		};
+
+		template <std::size_t Mode, typename Params, typename ... PredicateTs, typename ... ClauseTs>
+		struct clauses_unified_mask < Mode, tmp::type_list<Clause<Params, PredicateTs...>, ClauseTs...> >
+			: std::integral_constant<std::size_t,
+				names_mask<Params, typename satisfied_names<tmp::type_list<PredicateTs...>, typename mask_names<Params, Mode>::type>::type>::value
+				& clauses_unified_mask<Mode, tmp::type_list<ClauseTs...>>::value>
+		{
+		};
+
+		/* Evaluates to the mask of the arguments the given predicate is sure to have unified whenever it succeeds with the given adornment.
+		 * This is every argument, except for rules whose clauses are known (see 'clauses_unified_mask'). Fact types and built-ins unify all of
+		 * their arguments, as must any custom predicate, and the clauses of a 'RuleType' must give each of their parameters to a predicate
+		 * (see 'Rule::head'). */
+		template <typename PredT, std::size_t Mode, typename = void>
+		struct unified_mask : std::integral_constant<std::size_t, ~std::size_t{ 0 }>
+		{
+		};
+
+		template <typename PredT, std::size_t Mode>
+		struct unified_mask < PredT, Mode, tmp::void_t<typename PredT::ClauseTypes> > : clauses_unified_mask<Mode, typename PredT::ClauseTypes>
+		{
+		};
+
+		template <typename PredT, std::size_t KeyMask, std::size_t Mode>
+		struct unified_mask < Distinct<PredT, KeyMask>, Mode, void > : unified_mask<PredT, Mode>
+		{
+		};
+
+		/* Evaluates to the given set of unified var names, with the names the given predicate unifies when it succeeds added. */
+		template <typename PredicateT, typename Bound>
+		struct unified_names;
+
+		template <typename PredT, int ... ArgNs, typename Bound>
+		struct unified_names < Satisfy<PredT, ArgNs...>, Bound >
+			: set_union<Bound, typename mask_names<tmp::int_list<ArgNs...>, unified_mask<PredT, adornment_of<tmp::int_list<ArgNs...>, Bound>::value>::value>::type>
+		{
+		};
+
+		template <typename PredT, int ... ArgNs, typename Bound>
+		struct unified_names < NotSatisfy<PredT, ArgNs...>, Bound >
+		{
+			using type = Bound;
+		};
+
+		/* Evaluates to std::true_type if the given predicate finds all of its answers when called with the given adornment, so it may be
+		 * moved before the predicates that would have unified more of its arguments. Stored relations may be searched in any mode, and
+		 * built-ins declare the modes they compute their answers in with an 'Enumerates' member template. Anything else (such as a rule,
+		 * whose clauses may rely on their parameters being unified) is never called with fewer arguments unified than it was declared with. */
+		template <typename PredT, std::size_t Mode, typename = void>
+		struct enumerates : has_store<PredT>
+		{
+		};
+
+		template <typename PredT, std::size_t Mode>
+		struct enumerates < PredT, Mode, tmp::void_t<typename PredT::template Enumerates<Mode>> > : PredT::template Enumerates<Mode>
+		{
+		};
+
+		template <typename PredT, std::size_t KeyMask, std::size_t Mode>
+		struct enumerates < Distinct<PredT, KeyMask>, Mode, void > : enumerates<PredT, Mode>
+		{
+		};
+
+		/* Evaluates to the number of arguments of the given predicate that don't narrow the instances its store visits when it is called
+		 * with the given adornment (see the 'AccessCost' of each storage policy), or the given default if it has no store. */
+		template <typename PredT, std::size_t Mode, std::size_t Default, typename = void>
+		struct access_cost : std::integral_constant<std::size_t, Default>
+		{
+		};
+
+		template <typename PredT, std::size_t Mode, std::size_t Default>
+		struct access_cost < PredT, Mode, Default, tmp::void_t<typename PredT::Store> > : PredT::Store::template AccessCost<Mode>
+		{
+		};
+
+		template <typename PredT, std::size_t KeyMask, std::size_t Mode, std::size_t Default>
+		struct access_cost < Distinct<PredT, KeyMask>, Mode, Default, void > : access_cost<PredT, Mode, Default>
+		{
+		};
+
+		/* A predicate of a clause, with the set of its var names that were unified when it was reached in the clause's declared order.
+		 * 'Fixed' is set for a negated predicate that was reached with some of its arguments not unified, which nothing may be moved across. */
+		template <typename PredicateT, typename Needed, bool Fixed>
+		struct PlannedPredicate
+		{
+		};
+
+		/* Evaluates to a type_list of the given predicates as 'PlannedPredicate', given the set of names unified at the start of the clause. */
+		template <typename Bound, typename PredicateList, typename Result = tmp::type_list<>>
+		struct plan_predicates;
+
+		template <typename Bound, typename Result>
+		struct plan_predicates < Bound, tmp::type_list<>, Result >
+		{
+			using type = Result;
+		};
+
+		template <typename Bound, typename PredT, int ... ArgNs, typename ... PredicateTs, typename ... Rs>
+		struct plan_predicates < Bound, tmp::type_list<Satisfy<PredT, ArgNs...>, PredicateTs...>, tmp::type_list<Rs...> >
+			: plan_predicates<
+				typename unified_names<Satisfy<PredT, ArgNs...>, Bound>::type,
+				tmp::type_list<PredicateTs...>,
+				tmp::type_list<Rs..., PlannedPredicate<Satisfy<PredT, ArgNs...>, typename set_intersection<tmp::int_list<ArgNs...>, Bound>::type, false>>>
+		{
+		};
+
+		template <typename Bound, typename PredT, int ... ArgNs, typename ... PredicateTs, typename ... Rs>
+		struct plan_predicates < Bound, tmp::type_list<NotSatisfy<PredT, ArgNs...>, PredicateTs...>, tmp::type_list<Rs...> >
+			: plan_predicates<
+				Bound,
+				tmp::type_list<PredicateTs...>,
+				tmp::type_list<Rs..., PlannedPredicate<NotSatisfy<PredT, ArgNs...>, typename set_intersection<tmp::int_list<ArgNs...>, Bound>::type,
+					count_missing<typename predicate_names<NotSatisfy<PredT, ArgNs...>>::type, Bound>::value != 0>>>
+		{
+		};
+
+		/* Evaluates to the estimated cost of satisfying the given predicate next, when the names in the given set are unified.
+		 * Negations and lookups of unified arguments prune the search, so they're done as early as possible, followed by built-ins that
+		 * compute their answers, then relations by the number of arguments their store can't narrow the search by (or the number of arguments
+		 * they would have to enumerate, for relations without a store). A negation that has to scan its store is done once the cheaper
+		 * lookups and computations before it have had the chance to prune the search. */
+		template <typename PredicateT, typename Bound>
+		struct predicate_cost;
+
+		template <typename PredT, int ... ArgNs, typename Bound>
+		struct predicate_cost < NotSatisfy<PredT, ArgNs...>, Bound >
+			: std::integral_constant<std::size_t, 2 * access_cost<PredT, adornment_of<tmp::int_list<ArgNs...>, Bound>::value, 0>::value>
+		{
+		};
+
+		template <typename PredT, int ... ArgNs, typename Bound>
+		struct predicate_cost < Satisfy<PredT, ArgNs...>, Bound >
+		{
+		private:
+
+			static constexpr std::size_t missing = count_missing<typename predicate_names<Satisfy<PredT, ArgNs...>>::type, Bound>::value;
+
+			static constexpr std::size_t unnarrowed = access_cost<PredT, adornment_of<tmp::int_list<ArgNs...>, Bound>::value, missing>::value;
+
+		public:
+
+			static constexpr std::size_t value = !is_relation<PredT>::value ? (missing == 0 ? 1 : 2) : missing == 0 && unnarrowed == 0 ? 1 : 3 + 2 * unnarrowed;
+		};
+
+		/* Evaluates to std::true_type if the given predicate may be satisfied next when the names in the given set are unified, even if
+		 * fewer of its arguments are unified than in the declared order (see 'enumerates'). Negations never may, since they'd fail whenever
+		 * any way of unifying their other arguments exists. */
+		template <typename PredicateT, typename Bound>
+		struct may_hoist;
+
+		template <typename PredT, int ... ArgNs, typename Bound>
+		struct may_hoist < Satisfy<PredT, ArgNs...>, Bound > : enumerates<PredT, adornment_of<tmp::int_list<ArgNs...>, Bound>::value>
+		{
+		};
+
+		template <typename PredT, int ... ArgNs, typename Bound>
+		struct may_hoist < NotSatisfy<PredT, ArgNs...>, Bound > : std::false_type
+		{
+		};
+
+		/* Evaluates to the index of the predicate in the given list of 'PlannedPredicate' to satisfy next, when the names in the given set
+		 * are unified. Only predicates whose arguments are at least as unified as in the declared order, or that may be hoisted (see 'may_hoist'),
+		 * may be chosen, and none may be moved before a fixed predicate. Ties go to the earliest declared predicate. */
+		template <typename Bound, typename PlannedList, std::size_t I = 0, std::size_t BestI = 0, std::size_t BestCost = ~std::size_t{ 0 }>
+		struct select_predicate;
+
+		template <typename Bound, std::size_t I, std::size_t BestI, std::size_t BestCost>
+		struct select_predicate < Bound, tmp::type_list<>, I, BestI, BestCost > : std::integral_constant<std::size_t, BestI>
+		{
+		};
+
+		template <typename Bound, typename PredicateT, typename Needed, typename ... PlannedTs, std::size_t I, std::size_t BestI, std::size_t BestCost>
+		struct select_predicate < Bound, tmp::type_list<PlannedPredicate<PredicateT, Needed, true>, PlannedTs...>, I, BestI, BestCost >
+			: std::integral_constant<std::size_t, I == 0 ? 0 : BestI>
+		{
+		};
+
+		template <typename Bound, typename PredicateT, typename Needed, typename ... PlannedTs, std::size_t I, std::size_t BestI, std::size_t BestCost>
+		struct select_predicate < Bound, tmp::type_list<PlannedPredicate<PredicateT, Needed, false>, PlannedTs...>, I, BestI, BestCost >
+		{
+		private:
+
+			static constexpr std::size_t cost = predicate_cost<PredicateT, Bound>::value;
+
+			static constexpr bool allowed = count_missing<Needed, Bound>::value == 0 || may_hoist<PredicateT, Bound>::value;
+
+			static constexpr bool better = allowed && cost < BestCost;
+
+		public:
+
+			static constexpr std::size_t value = select_predicate<Bound, tmp::type_list<PlannedTs...>, I + 1, better ? I : BestI, better ? cost : BestCost>::value;
+		};
+
+		/* Splits the given type_list at the given index, into the element at that index ('type') and the list of the rest ('rest'). */
+		template <std::size_t I, typename List, typename Before = tmp::type_list<>>
+		struct split_at;
+
+		template <typename T, typename ... Ts, typename ... Bs>
+		struct split_at < 0, tmp::type_list<T, Ts...>, tmp::type_list<Bs...> >
+		{
+			using type = T;
+
+			using rest = tmp::type_list<Bs..., Ts...>;
+		};
+
+		template <std::size_t I, typename T, typename ... Ts, typename ... Bs>
+		struct split_at < I, tmp::type_list<T, Ts...>, tmp::type_list<Bs...> > : split_at<I - 1, tmp::type_list<Ts...>, tmp::type_list<Bs..., T>>
+		{
+		};
+
+		/* Evaluates to a type_list of the predicates in the given list of 'PlannedPredicate', in the order chosen by 'select_predicate'. */
+		template <typename Bound, typename PlannedList, typename Result = tmp::type_list<>>
+		struct order_planned_predicates;
+
+		template <typename Bound, typename Result>
+		struct order_planned_predicates < Bound, tmp::type_list<>, Result >
+		{
+			using type = Result;
+		};
+
+		template <typename Bound, typename PlannedT, typename ... PlannedTs, typename ... Rs>
+		struct order_planned_predicates < Bound, tmp::type_list<PlannedT, PlannedTs...>, tmp::type_list<Rs...> >
+		{
+		private:
+
+			using Chosen = split_at<select_predicate<Bound, tmp::type_list<PlannedT, PlannedTs...>>::value, tmp::type_list<PlannedT, PlannedTs...>>;
+
+			template <typename PredicateT, typename Needed, bool Fixed>
+			static PredicateT get_predicate(PlannedPredicate<PredicateT, Needed, Fixed>);
+
+			using Predicate = decltype(get_predicate(std::declval<typename Chosen::type>()));
+
+		public:
+
+			using type = typename order_planned_predicates<
+				typename unified_names<Predicate, Bound>::type, typename Chosen::rest, tmp::type_list<Rs..., Predicate>>::type;
+		};
+	}
+
+	/* Evaluates to a "tmp::type_list<...>" of the given clause predicates, reordered to be satisfied when the parameters whose bits are set in
+	 * 'Mask' are unified on entry. Predicates are chosen greedily by their estimated cost (see 'impl::predicate_cost'), and negations are
+	 * moved to the earliest point where all their arguments are unified.
+	 * A predicate is only moved before another if its arguments are still at least as unified as in the declared order, or if it can find all
+	 * of its answers with fewer of them unified (stored relations, and built-ins in the modes they compute in), so the clause has the same
+	 * answers (though possibly in a different order) as long as its predicates are free of side effects. */
+	template <typename Params, std::size_t Mask, typename PredicateList>
+	struct order_predicates
+	{
+	private:
+
+		using Bound = typename impl::mask_names<Params, Mask>::type;
+
+	public:
+
+		using type = typename impl::order_planned_predicates<Bound, typename impl::plan_predicates<Bound, PredicateList>::type>::type;
+	};
+
+	namespace impl
+	{
+		/* Marks the point in a list of predicates where several clauses that share the predicates before it diverge.
+		 * 'TailTs' - A "tmp::type_list<...>" of the rest of the predicates of each clause, satisfied in turn. */
+		template <typename ... TailTs>
+		struct Branch
+		{
+		};
+
+		/* Evaluates to a type_list of the leading elements the given type_lists have in common. */
+		template <typename ListA, typename ListB, typename Prefix = tmp::type_list<>>
+		struct common_prefix
+		{
+			using type = Prefix;
+		};
+
+		template <typename T, typename ... As, typename ... Bs, typename ... Ps>
+		struct common_prefix < tmp::type_list<T, As...>, tmp::type_list<T, Bs...>, tmp::type_list<Ps...> >
+			: common_prefix<tmp::type_list<As...>, tmp::type_list<Bs...>, tmp::type_list<Ps..., T>>
+		{
+		};
+
+		/* Evaluates to the given type_list without the given leading elements. */
+		template <typename Prefix, typename List>
+		struct drop_prefix;
+
+		template <typename List>
+		struct drop_prefix < tmp::type_list<>, List >
+		{
+			using type = List;
+		};
+
+		template <typename T, typename ... Ps, typename ... Ts>
+		struct drop_prefix < tmp::type_list<T, Ps...>, tmp::type_list<T, Ts...> > : drop_prefix<tmp::type_list<Ps...>, tmp::type_list<Ts...>>
+		{
+		};
+
+		/* Evaluates to a type_list of the predicates of the given clause, in the order chosen for the given adornment. */
+		template <typename ArgTypeList, std::size_t Mode, typename ClauseT>
+		struct clause_order;
+
+		template <typename ArgTypeList, std::size_t Mode, typename Params, typename ... PredicateTs>
+		struct clause_order < ArgTypeList, Mode, Clause<Params, PredicateTs...> >
+			: order_predicates<Params, Mode, tmp::type_list<PredicateTs...>>
+		{
+		};
+
+		/* A group of consecutive clauses of a rule with the same parameters, which are satisfied together as the given list of predicates
+		 * (ending with a 'Branch' to the rest of each clause). */
+		template <typename Params, typename PredicateList>
+		struct ClauseGroup
+		{
+		};
+
+		/* Evaluates to the 'ClauseGroup' for the given parameters and shared predicates, and the ordered predicates of each clause in it. */
+		template <typename Params, typename Prefix, typename OrderList>
+		struct make_clause_group;
+
+		template <typename Params, typename ... PrefixTs, typename ... OrderTs>
+		struct make_clause_group < Params, tmp::type_list<PrefixTs...>, tmp::type_list<OrderTs...> >
+		{
+			using type = ClauseGroup<Params, tmp::type_list<PrefixTs..., Branch<typename drop_prefix<tmp::type_list<PrefixTs...>, OrderTs>::type...>>>;
+		};
+
+		/* Evaluates to the finished group of clauses ('type'), and the list of clauses after it ('rest'). */
+		template <typename Params, typename Prefix, typename OrderList, typename ClauseList>
+		struct finish_clause_group
+		{
+			using type = typename make_clause_group<Params, Prefix, OrderList>::type;
+
+			using rest = ClauseList;
+		};
+
+		/* Extends the group of clauses with the given parameters and shared predicates with the clauses at the front of the given list, for as
+		 * long as they have the same parameters and their predicates start with at least one of the same predicates.
+		 * Evaluates to the group ('type'), and the list of clauses after it ('rest'). */
+		template <typename ArgTypeList, std::size_t Mode, typename Params, typename Prefix, typename OrderList, typename ClauseList>
+		struct take_clause_group : finish_clause_group<Params, Prefix, OrderList, ClauseList>
+		{
+		};
+
+		template <typename ArgTypeList, std::size_t Mode, typename Params, typename Prefix, typename ... OrderTs, typename ... PredicateTs, typename ... ClauseTs>
+		struct take_clause_group < ArgTypeList, Mode, Params, Prefix, tmp::type_list<OrderTs...>, tmp::type_list<Clause<Params, PredicateTs...>, ClauseTs...> >
+		{
+		private:
+
+			using Order = typename clause_order<ArgTypeList, Mode, Clause<Params, PredicateTs...>>::type;
+
+			using Shared = typename common_prefix<Prefix, Order>::type;
+
+			using Group = std::conditional_t<std::is_same<Shared, tmp::type_list<>>::value,
+				finish_clause_group<Params, Prefix, tmp::type_list<OrderTs...>, tmp::type_list<Clause<Params, PredicateTs...>, ClauseTs...>>,
+				take_clause_group<ArgTypeList, Mode, Params, Shared, tmp::type_list<OrderTs..., Order>, tmp::type_list<ClauseTs...>>>;
+
+		public:
+
+			using type = typename Group::type;
+
+			using rest = typename Group::rest;
+		};
+	}
+
+	/* Evaluates to a "tmp::type_list<...>" of the given clauses of a rule as groups of consecutive clauses ('impl::ClauseGroup'), for the
+	 * given adornment of the rule's arguments. Clauses with the same parameters whose predicates (in the order chosen by 'order_predicates')
+	 * start with some of the same predicates are grouped, and those are satisfied once for the group rather than once for each clause.
+	 * The clauses have the same answers, but those of a group are interleaved (for each way of satisfying the shared predicates, the
+	 * answers from each clause are given in turn).
+	 * 'ArgTypeList' - A "tmp::type_list<...>" of the rule's argument types. */
+	template <typename ArgTypeList, std::size_t Mode, typename ClauseList, typename Result = tmp::type_list<>>
+	struct group_clauses;
+
+	template <typename ArgTypeList, std::size_t Mode, typename Result>
+	struct group_clauses < ArgTypeList, Mode, tmp::type_list<>, Result >
+	{
+		using type = Result;
+	};
+
+	template <typename ArgTypeList, std::size_t Mode, typename Params, typename ... PredicateTs, typename ... ClauseTs, typename ... Rs>
+	struct group_clauses < ArgTypeList, Mode, tmp::type_list<Clause<Params, PredicateTs...>, ClauseTs...>, tmp::type_list<Rs...> >
+	{
+	private:
+
+		using Order = typename impl::clause_order<ArgTypeList, Mode, Clause<Params, PredicateTs...>>::type;
+
+		using Group = impl::take_clause_group<ArgTypeList, Mode, Params, Order, tmp::type_list<Order>, tmp::type_list<ClauseTs...>>;
+
+	public:
+
+		using type = typename group_clauses<ArgTypeList, Mode, typename Group::rest, tmp::type_list<Rs..., typename Group::type>>::type;
+	};
+}
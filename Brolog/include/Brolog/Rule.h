@@ -1,12 +1,128 @@
 // Rule.h - Copyright (c) 2016 Will Cassella
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <map>
+#include <set>
+#include "Adornment.h"
 #include "ArgPack.h"
 #include "DataBase.h"
 #include "Function.h"
+#include "Reorder.h"
 
 namespace brolog
 {
+	namespace impl
+	{
+		/* Evaluates to the var name at the given position of the given int_list. */
+		template <std::size_t I, typename Names>
+		struct name_at;
+
+		template <int N, int ... Ns>
+		struct name_at < 0, tmp::int_list<N, Ns...> > : std::integral_constant<int, N>
+		{
+		};
+
+		template <std::size_t I, int N, int ... Ns>
+		struct name_at < I, tmp::int_list<N, Ns...> > : name_at<I - 1, tmp::int_list<Ns...>>
+		{
+		};
+
+		/* Evaluates to the mask of the positions in the given parameter names that are constants, or whose name is repeated at a later position. */
+		template <typename Names, std::size_t I = 0>
+		struct constrained_params;
+
+		template <std::size_t I>
+		struct constrained_params < tmp::int_list<>, I > : std::integral_constant<std::size_t, 0>
+		{
+		};
+
+		template <int N, int ... Ns, std::size_t I>
+		struct constrained_params < tmp::int_list<N, Ns...>, I >
+			: std::integral_constant<std::size_t,
+				(is_constant_name<N>::value || tmp::element_of_int_list<N, tmp::int_list<Ns...>>::value ? std::size_t{ 1 } << I : 0)
+				| constrained_params<tmp::int_list<Ns...>, I + 1>::value>
+		{
+		};
+
+		template <std::size_t I, int N, typename ArgTupleT>
+		bool head_arg_matches(std::false_type /*constant*/, const ArgTupleT& /*args*/)
+		{
+			return true;
+		}
+
+		template <std::size_t I, int N, typename ArgTupleT>
+		bool head_arg_matches(std::true_type /*constant*/, const ArgTupleT& args)
+		{
+			const auto* arg = std::get<I>(args);
+			return !arg->unified() || arg->value() == constant_value<std::decay_t<decltype(arg->value())>, N>();
+		}
+
+		template <std::size_t I, std::size_t J, typename ArgTupleT>
+		bool head_args_match(std::false_type /*sameName*/, const ArgTupleT& /*args*/)
+		{
+			return true;
+		}
+
+		template <std::size_t I, std::size_t J, typename ArgTupleT>
+		bool head_args_match(std::true_type /*sameName*/, const ArgTupleT& args)
+		{
+			const auto* a = std::get<I>(args);
+			const auto* b = std::get<J>(args);
+			return !a->unified() || !b->unified() || a->value() == b->value();
+		}
+
+		/* Returns whether every unified argument given for a constant parameter has its value, and no two unified arguments given for
+		 * parameters with the same name have different values. Each index in 'Ks' stands for the pair of positions (Ks / N, Ks % N),
+		 * where 'N' is the number of parameters. */
+		template <typename Names, typename ArgTupleT, std::size_t ... Is, std::size_t ... Ks>
+		bool head_matches(const ArgTupleT& args, std::index_sequence<Is...>, std::index_sequence<Ks...>)
+		{
+			bool matches = true;
+			using swallow = int[];
+			(void)swallow{ 0, (matches = matches && head_arg_matches<Is, name_at<Is, Names>::value>(is_constant_name<name_at<Is, Names>::value>{}, args), 0)... };
+			(void)swallow{ 0, (matches = matches && head_args_match<Ks / std::tuple_size<ArgTupleT>::value, Ks % std::tuple_size<ArgTupleT>::value>(
+				std::integral_constant<bool,
+					(Ks / std::tuple_size<ArgTupleT>::value < Ks % std::tuple_size<ArgTupleT>::value) &&
+					name_at<Ks / std::tuple_size<ArgTupleT>::value, Names>::value == name_at<Ks % std::tuple_size<ArgTupleT>::value, Names>::value>{},
+				args), 0)... };
+
+			return matches;
+		}
+	}
+
+	/* What is known about the head (parameters) of a clause of a 'RuleType', so that 'RuleType::satisfy' may skip clauses that can't unify
+	 * with the arguments it was given, without creating their var chains. */
+	template <typename ArgTupleT>
+	struct ClauseHead
+	{
+		///////////////////
+		///   Methods   ///
+	public:
+
+		/* Returns whether a call with the given arguments (whose pattern of unified arguments is given) can't unify with this head. */
+		bool excludes(const ArgTupleT& args, std::size_t mask) const
+		{
+			return (mask & constrained) != 0 && !matches(args);
+		}
+
+		//////////////////
+		///   Fields   ///
+	public:
+
+		/* The mask of parameters that constrain the arguments given for them (constants, and those whose name is repeated later in the head).
+		 * If none of them are given unified arguments, the head can't fail to unify. */
+		std::size_t constrained;
+
+		/* Returns whether the unified arguments given for the constrained parameters may unify with the head. */
+		bool(*matches)(const ArgTupleT& args);
+	};
+
+	/* Type defining a 'Rule Type' whose clauses are inserted into the database at runtime (see 'DataBase::insert_rule').
+	 * Each clause is satisfied separately, so unlike those of a 'StaticRuleType', clauses that start with the same predicates don't share the
+	 * work of satisfying them (see 'group_clauses'). */
 	template <typename CookieT, typename ... ArgTs>
 	struct RuleType
 	{
@@ -17,121 +133,250 @@ namespace brolog
 		template <typename DBaseT>
 		using Instance = bool(*)(const DBaseT& dataBase, ArgTuple& args, const ContinueFn& next);
 
+		/* A clause of this rule in the database. */
+		template <typename DBaseT>
+		struct ClauseInstance
+		{
+			Instance<DBaseT> satisfy;
+
+			ClauseHead<ArgTuple> head;
+		};
+
 		template <typename DBaseT, typename ContinueFnT>
 		static bool satisfy(const DBaseT& dataBase, ArgTuple& args, const ContinueFnT& next)
 		{
 			// Enumerate all instances of this rule in the database
 			const auto& instances = static_cast<const DataBaseElement<DBaseT, RuleType>&>(dataBase).instances;
+			const auto mask = arg_pack_unified_mask<0>(args);
 
-			// If all the arguments to this rule were initally unified, we only have to find the first clause that works
-			bool initiallyUnified = arg_pack_unified<0>(args);
+			// If all the arguments to this rule were initally unified, there is only one answer so we can stop once it has been found
+			if (mask == (std::size_t{ 1 } << sizeof...(ArgTs)) - 1)
+			{
+				bool stop = false;
+				auto once = [&]() -> bool
+				{
+					stop = next();
+					return true;
+				};
 
-			// Stores whether this rule was ever satisfied
-			bool satisfied = false;
+				for (auto rule = instances.begin(); rule != instances.end(); ++rule)
+				{
+					// Skip clauses whose heads can't unify with the arguments
+					if (rule->head.excludes(args, mask))
+					{
+						continue;
+					}
 
-			for (auto rule = instances.begin(); rule != instances.end() && !(initiallyUnified && satisfied); ++rule)
+					if (rule->satisfy(dataBase, args, once))
+					{
+						return stop;
+					}
+				}
+
+				return false;
+			}
+
+			for (auto rule = instances.begin(); rule != instances.end(); ++rule)
 			{
-				satisfied |= (*rule)(dataBase, args, next);
+				// Skip clauses whose heads can't unify with the arguments
+				if (rule->head.excludes(args, mask))
+				{
+					continue;
+				}
+
+				if (rule->satisfy(dataBase, args, next))
+				{
+					return true;
+				}
 			}
 
-			return satisfied;
+			return false;
 		}
 
 		/* Creates a new instance of this fact and inserts it into the database. */
 		template <typename RuleInstance, typename DBaseT>
 		static void make_instance(DBaseT& dataBase)
 		{
-			static_cast<DataBaseElement<DBaseT, RuleType>&>(dataBase).instances.push_back(&RuleInstance::template satisfy<DBaseT>);
+			static_cast<DataBaseElement<DBaseT, RuleType>&>(dataBase).instances.push_back({ &RuleInstance::template satisfy<DBaseT>, RuleInstance::head() });
 		}
 	};
 
-	/* Declares a series of paramaters for this Rule. */
+	/* Declares a series of paramaters for this Rule. Parameters may be constants (see 'Const'), which the arguments must unify with.
+	 * Parameters can't be 'ANONYMOUS'. */
 	template <int ... Ns>
 	using Params = tmp::int_list<Ns...>;
 
 	/* The predicate to satisfy, and the way to satisfy it (argument names).
-	 * If any of the argument names have not previously been used in this rule, it is interpreted as a new unbound variable. */
+	 * The predicates of a rule may be satisfied in a different order than they're declared in (see 'order_predicates').
+	 * If any of the argument names have not previously been used in this rule, it is interpreted as a new unbound variable.
+	 * Arguments given as "Const<T, V>" are always unified with that value.
+	 * Arguments named 'ANONYMOUS' are new variables that the rest of the rule can't refer to, so if every other argument is unified
+	 * when the predicate is reached, only the first way of satisfying it is used. */
 	template <typename PredicateT, int ... ArgNs>
 	struct Satisfy
 	{
 	};
 
 	/* The predicate to not satify, and teh way to satisfy it (argument names).
-	 * Negation requires that all arguments have already been unified, and therfore does not allow introducing new arguments. */
+	 * Negation requires that all arguments have already been unified, and therfore does not allow introducing new arguments.
+	 * The exception is arguments named 'ANONYMOUS', which may have any value (so the predicate must not be satisfied for any of them). */
 	template <typename PredicateT, int ... ArgNs>
 	struct NotSatisfy
 	{
 	};
 
+	/* A clause of a 'StaticRuleType', declared with the same arguments as 'DataBase::insert_rule' (excluding the rule type). */
+	template <typename Params, typename ... PredicateTs>
+	struct Clause
+	{
+	};
+
 	template <typename TypeT, typename Params, typename ... PredicateTs>
 	struct Rule
 	{
+		static_assert(!tmp::element_of_int_list<ANONYMOUS, Params>::value,
+			"Rule parameters can't be 'ANONYMOUS', since nothing in the clause could unify them; name the parameter instead.");
+
 		using Type = TypeT;
 
 		template <typename DBaseT>
 		static bool satisfy(const DBaseT& dataBase, typename TypeT::ArgTuple& args, const ContinueFn& next)
+		{
+			// Dispatch to the version of this clause for the pattern of arguments unified on entry
+			using ModeFn = bool(*)(const DBaseT&, typename TypeT::ArgTuple&, const ContinueFn&);
+			static const auto modes = create_mode_table<DBaseT, ModeFn>(std::make_index_sequence<std::size_t{ 1 } << std::tuple_size<typename TypeT::ArgTuple>::value>{});
+
+			return modes[arg_pack_unified_mask<0>(args)](dataBase, args, next);
+		}
+
+		template <typename DBaseT, std::size_t Mode>
+		static bool satisfy(const DBaseT& dataBase, typename TypeT::ArgTuple& args, const ContinueFn& next, Adornment<Mode> mode)
+		{
+			// Satisfy the predicates in the order chosen for the parameters unified on entry (see 'order_predicates')
+			return satisfy_ordered(typename order_predicates<Params, Mode, tmp::type_list<PredicateTs...>>::type{}, mode, dataBase, args, next);
+		}
+
+		/* Satisfies the given list of predicates in the given order, rather than this rule's own predicates.
+		 * This is used to satisfy a group of clauses with the same parameters together (see 'group_clauses'). */
+		template <typename ... OrderedTs, typename DBaseT, std::size_t Mode>
+		static bool satisfy_ordered(
+			tmp::type_list<OrderedTs...>,
+			Adornment<Mode> /*mode*/,
+			const DBaseT& dataBase,
+			typename TypeT::ArgTuple& args,
+			const ContinueFn& next)
 		{
 			// Create an initial var chain
 			auto varChain = create_var_chain<VarChainRoot, ReferencedVarChainElement>(typename TypeT::ArgTypes{}, Params{});
 
-			// Fill it
-			if (!fill_initial_arg_chain<0>(typename TypeT::ArgTypes{}, Params{}, args, varChain))
+			// Fill it (any unification this does to the arguments is undone when this choice point is destroyed)
+			ChoicePoint choicePoint;
+			if (!fill_initial_arg_chain<0, ReferencedVarChainElement>(typename TypeT::ArgTypes{}, Params{}, args, varChain))
 			{
 				// Args don't work, backtrack immediately
 				return false;
 			}
 
-			// Satisfy the first predicate
-			return satisfy_predicate(tmp::type_list<PredicateTs...>{}, dataBase, next, varChain);
+			return satisfy_predicate(tmp::type_list<OrderedTs...>{}, typename impl::mask_names<Params, Mode>::type{}, dataBase, next, varChain);
+		}
+
+		/* Returns what 'RuleType::satisfy' needs to know about the parameters of this clause to skip it for arguments it can't unify with. */
+		static ClauseHead<typename TypeT::ArgTuple> head()
+		{
+			// Callers can't see the clauses of a 'RuleType', so they rely on each of them unifying every argument (see 'impl::unified_mask')
+			static_assert(impl::count_missing<typename impl::set_union<tmp::int_list<>, Params>::type,
+				typename impl::satisfied_names<tmp::type_list<PredicateTs...>>::type>::value == 0,
+				"Each parameter of a 'RuleType' clause must be a constant, or be given to one of its 'Satisfy' predicates.");
+			return{ impl::constrained_params<Params>::value, &head_matches };
 		}
 
 	private:
 
+		static bool head_matches(const typename TypeT::ArgTuple& args)
+		{
+			constexpr std::size_t N = std::tuple_size<typename TypeT::ArgTuple>::value;
+			return impl::head_matches<Params>(args, std::make_index_sequence<N>{}, std::make_index_sequence<N * N>{});
+		}
+
+		template <typename DBaseT, typename ModeFnT, std::size_t ... Modes>
+		static std::array<ModeFnT, sizeof...(Modes)> create_mode_table(std::index_sequence<Modes...>)
+		{
+			return{ { &satisfy_mode<DBaseT, Modes>... } };
+		}
+
+		template <typename DBaseT, std::size_t Mode>
+		static bool satisfy_mode(const DBaseT& dataBase, typename TypeT::ArgTuple& args, const ContinueFn& next)
+		{
+			return satisfy(dataBase, args, next, Adornment<Mode>{});
+		}
+
 		template <
 		typename PredT,
 		int ... ArgNs,
 		typename ... SatTs,
+		typename Bound,
 		typename DBaseT,
 		typename ContinueFnT,
 		typename ... OuterVarChainTs>
 		static bool satisfy_predicate(
 			tmp::type_list<Satisfy<PredT, ArgNs...>, SatTs...>,
+			Bound,
 			const DBaseT& dataBase,
 			const ContinueFnT& next,
 			OuterVarChainTs& ... outerVarChains)
 		{
+			// Give anonymous arguments names no other predicate uses
+			using Names = impl::name_anonymous_args<sizeof...(OuterVarChainTs), typename PredT::ArgTypes, tmp::int_list<ArgNs...>>;
+
 			// Create a new var chain for this scope (allows introducing new variables and type-checking existing ones)
 			auto localVarChain = create_var_chain<VarChainRoot, StoredVarChainElement>(
-				typename PredT::ArgTypes{}, tmp::int_list<ArgNs...>{}, outerVarChains...);
+				typename PredT::ArgTypes{}, typename Names::type{}, outerVarChains...);
 
 			// Create an arg pack for this predicate
-			auto argPack = create_arg_pack(typename PredT::ArgTypes{}, tmp::int_list<ArgNs...>{}, outerVarChains..., localVarChain);
+			auto argPack = create_arg_pack(typename PredT::ArgTypes{}, typename Names::type{}, outerVarChains..., localVarChain);
 
-			// Recursively satisfy predicates
-			return PredT::satisfy(dataBase, argPack,
-				[&]() {
-					return satisfy_predicate(tmp::type_list<SatTs...>{}, dataBase, next, outerVarChains..., localVarChain);
-			});
+			// Recursively satisfy predicates, with the arguments this one is sure to unify (see 'impl::unified_mask')
+			auto rest = [&]() {
+				return satisfy_predicate(tmp::type_list<SatTs...>{}, typename impl::unified_names<Satisfy<PredT, ArgNs...>, Bound>::type{},
+					dataBase, next, outerVarChains..., localVarChain);
+			};
+
+			// If every argument other than the anonymous ones is unified, the rest of the clause is the same for every way of
+			// satisfying the predicate, so we can stop once one has been found
+			using Mode = impl::adornment_of<typename Names::type, Bound>;
+			constexpr bool once = !std::is_same<typename Names::anonymous_names, tmp::int_list<>>::value
+				&& (Mode::value & Names::named_mask) == Names::named_mask;
+
+			return satisfy_args<typename impl::named_args<PredT, Names::named_mask>::type>(
+				std::integral_constant<bool, once>{}, Adornment<Mode::value>{}, dataBase, argPack, rest);
 		}
 
 		template <
 		typename PredT,
 		int ... ArgNs,
 		typename ... SatTs,
+		typename Bound,
 		typename DBaseT,
 		typename ContinueFnT,
 		typename ... OuterVarChainTs>
 		static bool satisfy_predicate(
 			tmp::type_list<NotSatisfy<PredT, ArgNs...>, SatTs...>,
+			Bound,
 			const DBaseT& database,
 			const ContinueFnT& next,
 			OuterVarChainTs& ... outerVarChains)
 		{
-			// Do NOT create a local var chain for this scope (since introducing new variables in negative predicates is not allowed)
-			auto argPack = create_arg_pack(typename PredT::ArgTypes{}, tmp::int_list<ArgNs...>{}, outerVarChains...);
+			// Do NOT create a local var chain for this scope (since introducing new variables in negative predicates is not allowed),
+			// except for any anonymous arguments
+			using Names = impl::name_anonymous_args<sizeof...(OuterVarChainTs), typename PredT::ArgTypes, tmp::int_list<ArgNs...>>;
+			auto anonymousVarChain = create_var_chain<VarChainRoot, StoredVarChainElement>(
+				typename Names::anonymous_types{}, typename Names::anonymous_names{});
+
+			auto argPack = create_arg_pack(typename PredT::ArgTypes{}, typename Names::type{}, outerVarChains..., anonymousVarChain);
 
+			// Stop at the first solution, since one is enough to fail
 			bool satisfied = false;
-			PredT::satisfy(database, argPack,
+			satisfy_adorned<PredT>(Adornment<impl::adornment_of<typename Names::type, Bound>::value>{}, database, argPack,
 				[&]() {
 				satisfied = true;
 				return true;
@@ -142,15 +387,58 @@ namespace brolog
 				return false;
 			}
 
-			return satisfy_predicate(tmp::type_list<SatTs...>{}, database, next, outerVarChains...);
+			return satisfy_predicate(tmp::type_list<SatTs...>{}, Bound{}, database, next, outerVarChains...);
+		}
+
+		template <typename PredT, std::size_t Mode, typename DBaseT, typename ArgPackT, typename ContinueFnT>
+		static bool satisfy_args(std::false_type /*once*/, Adornment<Mode> mode, const DBaseT& dataBase, ArgPackT& argPack, const ContinueFnT& next)
+		{
+			return satisfy_adorned<PredT>(mode, dataBase, argPack, next);
+		}
+
+		template <typename PredT, std::size_t Mode, typename DBaseT, typename ArgPackT, typename ContinueFnT>
+		static bool satisfy_args(std::true_type /*once*/, Adornment<Mode> mode, const DBaseT& dataBase, ArgPackT& argPack, const ContinueFnT& next)
+		{
+			bool stop = false;
+			auto once = [&]() -> bool
+			{
+				stop = next();
+				return true;
+			};
+
+			satisfy_adorned<PredT>(mode, dataBase, argPack, once);
+			return stop;
+		}
+
+		template <
+		typename ... TailTs,
+		typename Bound,
+		typename DBaseT,
+		typename ContinueFnT,
+		typename ... OuterVarChainTs>
+		static bool satisfy_predicate(
+			tmp::type_list<impl::Branch<TailTs...>>,
+			Bound,
+			const DBaseT& dataBase,
+			const ContinueFnT& next,
+			OuterVarChainTs& ... outerVarChains)
+		{
+			// Satisfy the rest of each clause that shares the predicates before this, in turn
+			bool stop = false;
+			using swallow = int[];
+			(void)swallow{ 0, (stop = stop || satisfy_predicate(TailTs{}, Bound{}, dataBase, next, outerVarChains...), 0)... };
+
+			return stop;
 		}
 
 		template <
+		typename Bound,
 		typename DBaseT,
 		typename ContinueFnT,
 		typename ... OuterVarChainTs>
 		static bool satisfy_predicate(
 			tmp::type_list<>,
+			Bound,
 			const DBaseT& /*dataBase*/,
 			const ContinueFnT& next,
 			OuterVarChainTs& ... /*outerVarCHains*/)
@@ -159,6 +447,532 @@ namespace brolog
 		}
 	};
 
+	/* Type defining a 'Rule Type' whose clauses are fixed at compile time, given as a series of "Clause<...>".
+	 * Clauses are called directly rather than through function pointers, so they may be inlined (continuations are still
+	 * type-erased at rule boundaries, so that recursive rules don't instantiate infinitely).
+	 * Consecutive clauses with the same parameters that start with the same predicates share the work of satisfying those (see 'group_clauses').
+	 * Declare a static rule type by deriving from this type, passing the derived type as 'SelfT' (so that clauses may refer to it).
+	 * Static rule types are not stored in the database, and should not be given to 'DataBase'.
+	 * 'ArgTypeList' - A "tmp::type_list<...>" of the rule's argument types. */
+	template <typename SelfT, typename ArgTypeList, typename ... ClauseTs>
+	struct StaticRuleType;
+
+	template <typename SelfT, typename ... ArgTs, typename ... ClauseTs>
+	struct StaticRuleType < SelfT, tmp::type_list<ArgTs...>, ClauseTs... >
+	{
+		using ArgTypes = tmp::type_list<ArgTs...>;
+
+		using ArgTuple = std::tuple<Var<ArgTs>*...>;
+
+		/* The list of clauses for this rule, used to find the fact types it depends on (see 'fact_dependencies'). */
+		using ClauseTypes = tmp::type_list<ClauseTs...>;
+
+		/* Static rule types may be called with an 'Adornment', which selects the version of each clause for it at compile time. */
+		using Adorned = std::true_type;
+
+		template <typename DBaseT, typename ContinueFnT>
+		static bool satisfy(const DBaseT& dataBase, ArgTuple& args, const ContinueFnT& next)
+		{
+			// Dispatch to the version of this rule for the pattern of arguments unified on entry
+			using ModeFn = bool(*)(const DBaseT&, ArgTuple&, const ContinueFn&);
+			static const auto modes = create_mode_table<DBaseT, ModeFn>(std::make_index_sequence<std::size_t{ 1 } << sizeof...(ArgTs)>{});
+
+			return modes[arg_pack_unified_mask<0>(args)](dataBase, args, ContinueFn(next));
+		}
+
+		template <typename DBaseT, typename ContinueFnT, std::size_t Mode>
+		static bool satisfy(const DBaseT& dataBase, ArgTuple& args, const ContinueFnT& next, Adornment<Mode> mode)
+		{
+			// If all the arguments to this rule were initally unified, there is only one answer so we can stop once it has been found
+			return satisfy_clauses(std::integral_constant<bool, Mode == impl::full_adornment<ArgTypes>::value>{}, mode, dataBase, args, ContinueFn(next));
+		}
+
+	private:
+
+		template <typename DBaseT, typename ModeFnT, std::size_t ... Modes>
+		static std::array<ModeFnT, sizeof...(Modes)> create_mode_table(std::index_sequence<Modes...>)
+		{
+			return{ { &satisfy_mode<DBaseT, Modes>... } };
+		}
+
+		template <typename DBaseT, std::size_t Mode>
+		static bool satisfy_mode(const DBaseT& dataBase, ArgTuple& args, const ContinueFn& next)
+		{
+			return satisfy_clauses(std::integral_constant<bool, Mode == impl::full_adornment<ArgTypes>::value>{}, Adornment<Mode>{}, dataBase, args, next);
+		}
+
+		template <std::size_t Mode, typename DBaseT>
+		static bool satisfy_clauses(std::false_type /*once*/, Adornment<Mode> mode, const DBaseT& dataBase, ArgTuple& args, const ContinueFn& next)
+		{
+			return satisfy_clause(typename group_clauses<ArgTypes, Mode, tmp::type_list<ClauseTs...>>::type{}, mode, dataBase, args, next);
+		}
+
+		template <std::size_t Mode, typename DBaseT>
+		static bool satisfy_clauses(std::true_type /*once*/, Adornment<Mode> mode, const DBaseT& dataBase, ArgTuple& args, const ContinueFn& next)
+		{
+			bool stop = false;
+			auto once = [&]() -> bool
+			{
+				stop = next();
+				return true;
+			};
+
+			return satisfy_clause(typename group_clauses<ArgTypes, Mode, tmp::type_list<ClauseTs...>>::type{}, mode, dataBase, args, ContinueFn(once)) && stop;
+		}
+
+		template <typename Params, typename PredicateList, typename ... RestTs, std::size_t Mode, typename DBaseT>
+		static bool satisfy_clause(
+			tmp::type_list<impl::ClauseGroup<Params, PredicateList>, RestTs...>,
+			Adornment<Mode> mode,
+			const DBaseT& dataBase,
+			ArgTuple& args,
+			const ContinueFn& next)
+		{
+			return Rule<SelfT, Params>::satisfy_ordered(PredicateList{}, mode, dataBase, args, next)
+				|| satisfy_clause(tmp::type_list<RestTs...>{}, mode, dataBase, args, next);
+		}
+
+		template <std::size_t Mode, typename DBaseT>
+		static bool satisfy_clause(
+			tmp::type_list<>,
+			Adornment<Mode> /*mode*/,
+			const DBaseT& /*dataBase*/,
+			ArgTuple& /*args*/,
+			const ContinueFn& /*next*/)
+		{
+			return false;
+		}
+	};
+
+	/* Predicate that satisfies the given predicate, but only continues once for each distinct answer (the values of its arguments), in the
+	 * order they were first found. Use this where the clauses of a rule may prove the same answer more than once, so that the predicates
+	 * following it aren't repeated for each proof, either within a clause ("Satisfy<Distinct<RSafe>, X, Y>") or as the term of a
+	 * query ("create_query<Distinct<RSafe>>(...)"). Answers are only remembered for the duration of each call, nothing is kept between them.
+	 * Anonymous arguments aren't part of the answer, so answers that only differ in them are given once. This makes "Distinct" useful for
+	 * projecting a rule onto some of its arguments ("Satisfy<Distinct<RSafe>, X, ANONYMOUS>").
+	 * Tabled and materialized rule types already give distinct answers, so they don't need this unless some arguments are anonymous.
+	 * Argument types must be less-than comparable.
+	 * 'KeyMask' - The mask of the positions of the arguments that make up an answer (set to the named arguments where this is used). */
+	template <typename PredT, std::size_t KeyMask = ~std::size_t{ 0 }>
+	struct Distinct
+	{
+		using ArgTypes = typename PredT::ArgTypes;
+
+		/* 'Distinct' passes its 'Adornment' on to the given predicate. */
+		using Adorned = std::true_type;
+
+		/* Answers are only made up of the named arguments (see 'impl::named_args'). */
+		template <std::size_t NamedMask>
+		using Named = Distinct<PredT, KeyMask & NamedMask>;
+
+		template <typename DBaseT, typename ArgTupleT, typename ContinueFnT>
+		static bool satisfy(const DBaseT& dataBase, ArgTupleT& args, const ContinueFnT& next)
+		{
+			auto satisfyPred = [&](const auto& fn) -> bool
+			{
+				return PredT::satisfy(dataBase, args, fn);
+			};
+
+			if ((arg_pack_unified_mask<0>(args) & Key::value) == Key::value)
+			{
+				return satisfy_answers(std::true_type{}, args, satisfyPred, next);
+			}
+
+			return satisfy_answers(std::false_type{}, args, satisfyPred, next);
+		}
+
+		template <typename DBaseT, typename ArgTupleT, typename ContinueFnT, std::size_t Mode>
+		static bool satisfy(const DBaseT& dataBase, ArgTupleT& args, const ContinueFnT& next, Adornment<Mode> mode)
+		{
+			auto satisfyPred = [&](const auto& fn) -> bool
+			{
+				return satisfy_adorned<PredT>(mode, dataBase, args, fn);
+			};
+
+			return satisfy_answers(std::integral_constant<bool, (Mode & Key::value) == Key::value>{}, args, satisfyPred, next);
+		}
+
+	private:
+
+		/* The mask of the positions of the arguments that make up an answer. */
+		using Key = std::integral_constant<std::size_t, KeyMask & impl::full_adornment<ArgTypes>::value>;
+
+		template <typename ArgTupleT, typename SatisfyFnT, typename ContinueFnT>
+		static bool satisfy_answers(std::true_type /*unified*/, ArgTupleT& /*args*/, const SatisfyFnT& satisfyPred, const ContinueFnT& next)
+		{
+			// If all the arguments of the answer were initially unified, there is only one answer so we can stop once it has been found
+			bool stop = false;
+			auto once = [&]() -> bool
+			{
+				stop = next();
+				return true;
+			};
+
+			satisfyPred(once);
+			return stop;
+		}
+
+		template <typename ArgTupleT, typename SatisfyFnT, typename ContinueFnT>
+		static bool satisfy_answers(std::false_type /*unified*/, ArgTupleT& args, const SatisfyFnT& satisfyPred, const ContinueFnT& next)
+		{
+			// Skip answers that have already been given
+			using KeyIndices = typename tmp::mask_indices<Key::value, std::tuple_size<ArgTupleT>::value>::type;
+			std::set<decltype(arg_pack_values(args, KeyIndices{}))> answers;
+			auto unique = [&]() -> bool
+			{
+				if (!answers.insert(arg_pack_values(args, KeyIndices{})).second)
+				{
+					return false;
+				}
+
+				return next();
+			};
+
+			return satisfyPred(unique);
+		}
+	};
+
+	namespace impl
+	{
+		/* Evaluates to the predicate type of a "Satisfy<...>" or "NotSatisfy<...>". */
+		template <typename PredicateT>
+		struct predicate_type;
+
+		template <typename PredT, int ... ArgNs>
+		struct predicate_type < Satisfy<PredT, ArgNs...> >
+		{
+			using type = PredT;
+		};
+
+		template <typename PredT, int ... ArgNs>
+		struct predicate_type < NotSatisfy<PredT, ArgNs...> >
+		{
+			using type = PredT;
+		};
+
+		/* Given a type_list of clauses, evaluates to the given type_list with the predicate types of every clause appended. */
+		template <typename ClauseList, typename Result>
+		struct append_clause_predicates;
+
+		template <typename Params, typename ... PredicateTs, typename ... ClauseTs, typename ... Rs>
+		struct append_clause_predicates < tmp::type_list<Clause<Params, PredicateTs...>, ClauseTs...>, tmp::type_list<Rs...> >
+			: append_clause_predicates<tmp::type_list<ClauseTs...>, tmp::type_list<Rs..., typename predicate_type<PredicateTs>::type...>>
+		{
+		};
+
+		template <typename ... Rs>
+		struct append_clause_predicates < tmp::type_list<>, tmp::type_list<Rs...> >
+		{
+			using type = tmp::type_list<Rs...>;
+		};
+
+		template <typename PendingList, typename VisitedList, typename FactList>
+		struct collect_fact_dependencies;
+
+		/* Adds the fact types the given predicate depends on to the fact list.
+		 * Predicates that are neither fact types nor rule types with clauses (such as 'Sum') don't depend on anything. */
+		template <typename PredT, typename PendingList, typename VisitedList, typename FactList, typename = void>
+		struct visit_predicate : collect_fact_dependencies<PendingList, VisitedList, FactList>
+		{
+		};
+
+		template <typename PredT, typename PendingList, typename VisitedList, typename ... FactTs>
+		struct visit_predicate < PredT, PendingList, VisitedList, tmp::type_list<FactTs...>, tmp::void_t<typename PredT::Store> >
+			: collect_fact_dependencies<PendingList, VisitedList, tmp::type_list<FactTs..., PredT>>
+		{
+		};
+
+		template <typename PredT, typename PendingList, typename VisitedList, typename FactList>
+		struct visit_predicate < PredT, PendingList, VisitedList, FactList, tmp::void_t<typename PredT::ClauseTypes> >
+			: collect_fact_dependencies<typename append_clause_predicates<typename PredT::ClauseTypes, PendingList>::type, VisitedList, FactList>
+		{
+		};
+
+		template <typename PredT, std::size_t KeyMask, typename ... PendingTs, typename VisitedList, typename FactList>
+		struct visit_predicate < Distinct<PredT, KeyMask>, tmp::type_list<PendingTs...>, VisitedList, FactList, void >
+			: collect_fact_dependencies<tmp::type_list<PredT, PendingTs...>, VisitedList, FactList>
+		{
+		};
+
+		template <typename CookieT, typename ... ArgTs, typename PendingList, typename VisitedList, typename FactList>
+		struct visit_predicate < RuleType<CookieT, ArgTs...>, PendingList, VisitedList, FactList, void >
+		{
+			static_assert(sizeof(CookieT*) == 0, "The clauses of a 'RuleType' are only known at runtime, so its dependencies can't be found.");
+		};
+
+		/* Visits each pending predicate that has not already been visited (rules may be recursive). */
+		template <typename PredT, typename ... PendingTs, typename ... VisitedTs, typename FactList>
+		struct collect_fact_dependencies < tmp::type_list<PredT, PendingTs...>, tmp::type_list<VisitedTs...>, FactList >
+			: std::conditional_t<tmp::element_of<tmp::type_list<VisitedTs...>, PredT>::value,
+				collect_fact_dependencies<tmp::type_list<PendingTs...>, tmp::type_list<VisitedTs...>, FactList>,
+				visit_predicate<PredT, tmp::type_list<PendingTs...>, tmp::type_list<VisitedTs..., PredT>, FactList>>
+		{
+		};
+
+		template <typename VisitedList, typename FactList>
+		struct collect_fact_dependencies < tmp::type_list<>, VisitedList, FactList >
+		{
+			using type = FactList;
+
+			/* Every predicate that was visited. */
+			using visited = VisitedList;
+		};
+	}
+
+	/* Evaluates to a "tmp::type_list<...>" of every fact type the given predicate depends on, either directly or through the clauses
+	 * of rules with clauses fixed at compile time (such as 'StaticRuleType'). */
+	template <typename PredicateT>
+	struct fact_dependencies : impl::collect_fact_dependencies<tmp::type_list<PredicateT>, tmp::type_list<>, tmp::type_list<>>
+	{
+	};
+
+	/* Evaluates to a "tmp::type_list<...>" of the given predicate and every predicate it depends on, in the same way as 'fact_dependencies'. */
+	template <typename PredicateT>
+	struct predicate_dependencies
+	{
+		using type = typename impl::collect_fact_dependencies<tmp::type_list<PredicateT>, tmp::type_list<>, tmp::type_list<>>::visited;
+	};
+
+	/* Evaluates to std::true_type if the given predicate depends on the given rule type (directly or through other rules), std::false_type otherwise. */
+	template <typename PredicateT, typename RuleT>
+	struct depends_on : tmp::element_of<typename predicate_dependencies<PredicateT>::type, RuleT>
+	{
+	};
+
+	/* Returns the sum of the generations of the given fact types in the database, which increases whenever any of them are modified. */
+	template <typename DBaseT, typename ... FactTs>
+	std::size_t get_generation(const DBaseT& dataBase, tmp::type_list<FactTs...>)
+	{
+		std::size_t result = 0;
+
+		using swallow = int[];
+		(void)swallow{ 0, (result += dataBase.template get_generation<FactTs>(), 0)... };
+
+		return result;
+	}
+
+	/* Table policy for 'BasicTabledRuleType' that discards tables at the end of each query. */
+	struct QueryTables
+	{
+		/* Returns the map of tables for the given rule in the given database. */
+		template <typename RuleT, typename TableMapT, typename DBaseT>
+		static TableMapT& get_tables(const DBaseT& dataBase)
+		{
+			thread_local std::map<const void*, TableMapT> tables;
+			thread_local std::size_t epoch = 0;
+
+			// Discard tables from previous queries
+			auto& state = TableState::current();
+			if (epoch != state.epoch)
+			{
+				tables.clear();
+				epoch = state.epoch;
+			}
+
+			return tables[&dataBase];
+		}
+	};
+
+	/* Table policy for 'BasicTabledRuleType' that keeps tables in the database between queries,
+	 * and discards them when any fact type the rule depends on is modified.
+	 * Since a table outlives the query that filled it, it must only ever be reused for the exact call variant it was found for
+	 * (including which unbound arguments were aliased), or a single restricted call would hide answers from every later query. */
+	struct CachedTables
+	{
+		/* Returns the map of tables for the given rule in the given database. */
+		template <typename RuleT, typename TableMapT, typename DBaseT>
+		static TableMapT& get_tables(const DBaseT& dataBase)
+		{
+			auto& cache = dataBase.template get_rule_cache<RuleT, Cache<TableMapT>>();
+
+			// Discard the tables if the facts they were found from have changed
+			const auto generation = get_generation(dataBase, typename fact_dependencies<RuleT>::type{});
+			if (cache.generation != generation)
+			{
+				cache.tables.clear();
+				cache.generation = generation;
+			}
+
+			return cache.tables;
+		}
+
+	private:
+
+		template <typename TableMapT>
+		struct Cache
+		{
+			/* The generation of the rule's dependencies when the tables were found. */
+			std::size_t generation = 0;
+
+			TableMapT tables;
+		};
+	};
+
+	/* Type defining a 'Rule Type' with clauses fixed at compile time (as with 'StaticRuleType'), whose answers are tabled.
+	 * The answers for each call variant (which arguments were unified on entry, their values, and which of the rest are aliased together)
+	 * are found once and recorded, and further calls with the same variant use the recorded answers for as long as 'TablePolicyT' keeps them.
+	 * Recursive calls to a variant that is still being evaluated use the answers found so far, and the variant is re-evaluated until
+	 * no more answers are found, so left-recursive rules terminate.
+	 * Answers are distinct, and are given in the order they were first found.
+	 * Argument types must be default-constructible and less-than comparable, and a tabled rule must not be negated
+	 * (with 'NotSatisfy') by any rule it depends on.
+	 * 'TablePolicyT' - Where tables are kept, and for how long (such as 'QueryTables'). */
+	template <typename SelfT, typename TablePolicyT, typename ArgTypeList, typename ... ClauseTs>
+	struct BasicTabledRuleType;
+
+	template <typename SelfT, typename TablePolicyT, typename ... ArgTs, typename ... ClauseTs>
+	struct BasicTabledRuleType < SelfT, TablePolicyT, tmp::type_list<ArgTs...>, ClauseTs... >
+	{
+		using ArgTypes = tmp::type_list<ArgTs...>;
+
+		using ArgTuple = std::tuple<Var<ArgTs>*...>;
+
+		using Instance = std::tuple<ArgTs...>;
+
+		/* The list of clauses for this rule, used to find the fact types it depends on (see 'fact_dependencies'). */
+		using ClauseTypes = tmp::type_list<ClauseTs...>;
+
+	private:
+
+		using Clauses = StaticRuleType<SelfT, ArgTypes, ClauseTs...>;
+
+		struct Table : TableBase
+		{
+			/* Answers in the order they were found. */
+			std::vector<Instance> answers;
+
+			std::set<Instance> answer_set;
+		};
+
+		/* Tables are identified by the mask of unified arguments, which of the others are aliased together (see 'arg_pack_aliases'),
+		 * and the values of the unified arguments (unbound arguments are default-constructed).
+		 * Aliasing is part of the variant since it restricts the answers, so a call such as "R(X, X)" can't share a table with "R(X, Y)". */
+		using TableKey = std::tuple<std::size_t, std::array<std::size_t, sizeof...(ArgTs)>, Instance>;
+
+		using TableMap = std::map<TableKey, Table>;
+
+		///////////////////
+		///   Methods   ///
+	public:
+
+		template <typename DBaseT, typename ContinueFnT>
+		static bool satisfy(const DBaseT& dataBase, ArgTuple& args, const ContinueFnT& next)
+		{
+			auto& state = TableState::current();
+			auto& tables = TablePolicyT::template get_tables<SelfT, TableMap>(dataBase);
+			auto& table = tables[TableKey{ arg_pack_unified_mask<0>(args), arg_pack_aliases(args), get_variant_values(args, std::index_sequence_for<ArgTs...>{}) }];
+
+			if (table.evaluating)
+			{
+				// This is a recursive call to a variant being evaluated, so any tables evaluated since then depend on it
+				table.recursed = true;
+				for (auto i = table.depth + 1; i < state.stack.size(); ++i)
+				{
+					state.stack[i]->low = std::min(state.stack[i]->low, table.depth);
+				}
+			}
+			else if (!table.complete)
+			{
+				evaluate(dataBase, args, table);
+			}
+
+			// Unify with each answer (answers may be added while doing so, if the table is incomplete)
+			// A caller that stops early has every answer it needs, so it hasn't missed any of the rest
+			bool stop = false;
+			for (std::size_t i = 0; i < table.answers.size() && !stop; ++i)
+			{
+				const auto answer = table.answers[i];
+				stop = unify_arg_pack(args, answer, next);
+			}
+
+			if (table.evaluating)
+			{
+				table.num_seen = std::min(table.num_seen, table.answers.size());
+			}
+
+			return stop;
+		}
+
+	private:
+
+		template <std::size_t ... Is>
+		static Instance get_variant_values(const ArgTuple& args, std::index_sequence<Is...>)
+		{
+			return Instance((std::get<Is>(args)->unified() ? std::get<Is>(args)->value() : ArgTs{})...);
+		}
+
+		/* Finds the answers for the given table, by evaluating the clauses until a fixpoint is reached. */
+		template <typename DBaseT>
+		static void evaluate(const DBaseT& dataBase, ArgTuple& args, Table& table)
+		{
+			auto& state = TableState::current();
+			const auto incompleteMark = state.incomplete.size();
+
+			table.evaluating = true;
+			table.depth = state.stack.size();
+			table.low = table.depth;
+			state.stack.push_back(&table);
+
+			while (true)
+			{
+				table.recursed = false;
+				table.num_seen = std::numeric_limits<std::size_t>::max();
+				const auto numAnswers = state.num_answers;
+				const auto numTableAnswers = table.answers.size();
+
+				Clauses::satisfy(dataBase, args, [&]() -> bool
+				{
+					auto answer = arg_pack_values(args);
+					if (table.answer_set.insert(answer).second)
+					{
+						table.answers.push_back(std::move(answer));
+						state.num_answers += 1;
+					}
+
+					return false;
+				});
+
+				// Another pass is only required if incomplete answers were used by a recursive call, and answers were found that it
+				// may have missed (either in this table after the call finished, or in another table).
+				// If this table depends on a table further down the stack, that table's evaluation will call this again.
+				const bool missedOwn = table.num_seen < table.answers.size();
+				const bool foundOther = state.num_answers - numAnswers != table.answers.size() - numTableAnswers;
+				if (!table.recursed || !(missedOwn || foundOther) || table.low < table.depth)
+				{
+					break;
+				}
+			}
+
+			state.stack.pop_back();
+			table.evaluating = false;
+
+			if (table.low < table.depth)
+			{
+				state.incomplete.push_back(&table);
+				return;
+			}
+
+			// This table reached a fixpoint, so it and every table that depended on it are complete
+			table.complete = true;
+			for (auto i = incompleteMark; i < state.incomplete.size(); ++i)
+			{
+				state.incomplete[i]->complete = true;
+			}
+
+			state.incomplete.resize(incompleteMark);
+		}
+	};
+
+	/* Tabled rule type (see 'BasicTabledRuleType') whose tables are only reused within the same query. */
+	template <typename SelfT, typename ArgTypeList, typename ... ClauseTs>
+	using TabledRuleType = BasicTabledRuleType<SelfT, QueryTables, ArgTypeList, ClauseTs...>;
+
+	/* Tabled rule type (see 'BasicTabledRuleType') whose tables are kept in the database between queries, and are reused until
+	 * any fact type the rule depends on (found at compile time with 'fact_dependencies') is inserted into or removed from.
+	 * Every rule the cached rule depends on must have clauses fixed at compile time. */
+	template <typename SelfT, typename ArgTypeList, typename ... ClauseTs>
+	using CachedRuleType = BasicTabledRuleType<SelfT, CachedTables, ArgTypeList, ClauseTs...>;
+
 	template <typename DBase, typename CookieT, typename ... ArgTs>
 	struct DataBaseElement< DBase, RuleType<CookieT, ArgTs...> >
 	{
@@ -168,6 +982,6 @@ namespace brolog
 
 		/* Rules are stored as a vector instead of a set, since there is less likelyhood of duplication
 		 * and it allows for control over iteration order. */
-		std::vector<typename RuleType<CookieT, ArgTs...>::template Instance<DBase>> instances;
+		std::vector<typename RuleType<CookieT, ArgTs...>::template ClauseInstance<DBase>> instances;
 	};
 }
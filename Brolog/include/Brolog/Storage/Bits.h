@@ -0,0 +1,40 @@
+// Bits.h - Copyright (c) 2016 Will Cassella
+#pragma once
+
+#include <cstdint>
+
+#ifdef _MSC_VER
+#	include <intrin.h>
+#endif
+
+namespace brolog
+{
+	/* Returns the index of the lowest set bit in the given value.
+	 * NOTE: The value must not be zero. */
+	inline unsigned count_trailing_zeros(std::uint32_t value)
+	{
+#ifdef _MSC_VER
+		unsigned long result;
+		_BitScanForward(&result, value);
+		return static_cast<unsigned>(result);
+#else
+		return static_cast<unsigned>(__builtin_ctz(value));
+#endif
+	}
+
+	/* Returns the index of the lowest set bit in the given value.
+	 * NOTE: The value must not be zero. */
+	inline unsigned count_trailing_zeros(std::uint64_t value)
+	{
+#if defined(_MSC_VER) && defined(_M_X64)
+		unsigned long result;
+		_BitScanForward64(&result, value);
+		return static_cast<unsigned>(result);
+#elif defined(_MSC_VER)
+		const auto low = static_cast<std::uint32_t>(value);
+		return low != 0 ? count_trailing_zeros(low) : 32 + count_trailing_zeros(static_cast<std::uint32_t>(value >> 32));
+#else
+		return static_cast<unsigned>(__builtin_ctzll(value));
+#endif
+	}
+}
@@ -0,0 +1,266 @@
+// Column.h - Copyright (c) 2016 Will Cassella
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+#include "../ArgPack.h"
+#include "Bits.h"
+
+// Select the widest supported instruction set for filtering columns (define 'BROLOG_NO_SIMD' to always use scalar code)
+#if !defined(BROLOG_NO_SIMD) && defined(__AVX2__)
+#	include <immintrin.h>
+#	define BROLOG_SIMD_AVX2
+#elif !defined(BROLOG_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#	include <emmintrin.h>
+#	define BROLOG_SIMD_SSE2
+#endif
+
+namespace brolog
+{
+	/* The number of rows 'ColumnStorage' filters at a time. */
+	constexpr std::size_t ColumnBlockSize = 32;
+
+	/* Returns a mask of which of the 'count' values (at most 'ColumnBlockSize') starting at 'column' are equal to 'value'. */
+	template <typename T>
+	auto match_column_block(const T* column, std::size_t count, const T& value)
+		-> std::enable_if_t<!(std::is_integral<T>::value && sizeof(T) == 4), std::uint32_t>
+	{
+		std::uint32_t result = 0;
+
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			if (column[i] == value)
+			{
+				result |= std::uint32_t{ 1 } << i;
+			}
+		}
+
+		return result;
+	}
+
+	/* Overload of 'match_column_block' for 32-bit integers, which compares a whole block with vector instructions where available. */
+	template <typename T>
+	auto match_column_block(const T* column, std::size_t count, const T& value)
+		-> std::enable_if_t<std::is_integral<T>::value && sizeof(T) == 4, std::uint32_t>
+	{
+		std::uint32_t result = 0;
+
+#if defined(BROLOG_SIMD_AVX2)
+		if (count == ColumnBlockSize)
+		{
+			const auto key = _mm256_set1_epi32(static_cast<int>(value));
+			for (std::size_t i = 0; i < ColumnBlockSize; i += 8)
+			{
+				const auto values = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(column + i));
+				const auto equal = _mm256_castsi256_ps(_mm256_cmpeq_epi32(values, key));
+				result |= static_cast<std::uint32_t>(_mm256_movemask_ps(equal)) << i;
+			}
+
+			return result;
+		}
+#elif defined(BROLOG_SIMD_SSE2)
+		if (count == ColumnBlockSize)
+		{
+			const auto key = _mm_set1_epi32(static_cast<int>(value));
+			for (std::size_t i = 0; i < ColumnBlockSize; i += 4)
+			{
+				const auto values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(column + i));
+				const auto equal = _mm_castsi128_ps(_mm_cmpeq_epi32(values, key));
+				result |= static_cast<std::uint32_t>(_mm_movemask_ps(equal)) << i;
+			}
+
+			return result;
+		}
+#endif
+
+		// Scalar fallback, also used for the final partial block
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			if (column[i] == value)
+			{
+				result |= std::uint32_t{ 1 } << i;
+			}
+		}
+
+		return result;
+	}
+
+	/* Fact storage policy that keeps each argument of every instance in its own contiguous array (struct-of-arrays).
+	 * Queries with unified arguments filter the columns for those arguments a block at a time (with SSE2 or AVX2 compares
+	 * for 32-bit integer columns), and only matching rows are unified with the 'arg pack'.
+	 * Instances are not kept in any particular order, and inserting must check every row for a duplicate, so inserting 'n' instances
+	 * takes O(n^2) time. This is only suited to small fact types made of plain values that are rarely modified (or to materialized rules
+	 * with few answers), since each instance costs only the size of its values. Use 'HashStorage' or 'OrderedStorage' for anything else. */
+	struct ColumnStorage
+	{
+		template <typename ... ArgTs>
+		struct Store
+		{
+			using Instance = std::tuple<ArgTs...>;
+
+			using ArgPack = std::tuple<Var<ArgTs>*...>;
+
+			static_assert(sizeof...(ArgTs) < 64, "Too many arguments for a 'ColumnStorage' fact type.");
+			static_assert(!tmp::element_of<tmp::type_list<ArgTs...>, bool>::value, "'ColumnStorage' does not support 'bool' arguments, since 'std::vector<bool>' is not contiguous.");
+
+			/* The number of arguments that don't narrow the rows visited for the given pattern of unified arguments (see 'impl::predicate_cost').
+			 * Unified arguments only filter the rows, every row is still visited. */
+			template <std::size_t Mode>
+			using AccessCost = std::integral_constant<std::size_t, sizeof...(ArgTs)>;
+
+		private:
+
+			static constexpr std::size_t NotFound = ~std::size_t{ 0 };
+
+			///////////////////
+			///   Methods   ///
+		public:
+
+			/* Unifies the given 'arg pack' with every matching instance, calling 'next' for each. */
+			template <typename ContinueFnT>
+			bool satisfy(const ArgPack& args, const ContinueFnT& next) const
+			{
+				const auto mask = arg_pack_unified_mask<0>(args);
+
+				// If all arguments were initially unified, this is just a membership test
+				if (mask == (std::size_t{ 1 } << sizeof...(ArgTs)) - 1)
+				{
+					if (this->find_row(args, mask) == NotFound)
+					{
+						return false;
+					}
+
+					return next();
+				}
+
+				// Filter the rows a block at a time, and unify with each row that matches
+				for (std::size_t begin = 0; begin < this->size(); begin += ColumnBlockSize)
+				{
+					const auto count = std::min(ColumnBlockSize, this->size() - begin);
+					auto matches = this->match_block(args, mask, begin, count, std::index_sequence_for<ArgTs...>{});
+
+					while (matches != 0)
+					{
+						const auto row = begin + count_trailing_zeros(matches);
+						matches &= matches - 1;
+
+						if (unify_arg_pack(args, this->get_row(row, std::index_sequence_for<ArgTs...>{}), next))
+						{
+							return true;
+						}
+					}
+				}
+
+				return false;
+			}
+
+			/* Inserts the given instance. Has no effect if an equivalent instance already exists.
+			 * NOTE: This scans every row for a duplicate first. */
+			void insert(const Instance& instance)
+			{
+				if (!this->contains(instance))
+				{
+					this->push_row(instance, std::index_sequence_for<ArgTs...>{});
+				}
+			}
+
+			/* Removes the given instance. Has no effect if no equivalent instance exists.
+			 * The last instance is moved into the removed instance's place. */
+			void remove(const Instance& instance)
+			{
+				const auto row = this->find_row(instance, (std::size_t{ 1 } << sizeof...(ArgTs)) - 1);
+				if (row != NotFound)
+				{
+					this->swap_remove_row(row, std::index_sequence_for<ArgTs...>{});
+				}
+			}
+
+			/* Returns whether an equivalent instance exists. */
+			bool contains(const Instance& instance) const
+			{
+				return this->find_row(instance, (std::size_t{ 1 } << sizeof...(ArgTs)) - 1) != NotFound;
+			}
+
+			/* Returns the number of instances stored. */
+			std::size_t size() const
+			{
+				return std::get<0>(_columns).size();
+			}
+
+		private:
+
+			/* Returns the value to filter column 'I' by, from either an 'arg pack' or an instance. */
+			template <std::size_t I>
+			static const auto& key_value(const ArgPack& args)
+			{
+				return std::get<I>(args)->value();
+			}
+
+			template <std::size_t I>
+			static const auto& key_value(const Instance& instance)
+			{
+				return std::get<I>(instance);
+			}
+
+			/* Returns a mask of the rows in the given block that match the key in each column set in 'mask'. */
+			template <typename KeyT, std::size_t ... Is>
+			std::uint32_t match_block(const KeyT& key, std::size_t mask, std::size_t begin, std::size_t count, std::index_sequence<Is...>) const
+			{
+				auto result = count == ColumnBlockSize ? ~std::uint32_t{ 0 } : (std::uint32_t{ 1 } << count) - 1;
+
+				using swallow = int[];
+				(void)swallow{ 0, (result != 0 && (mask & (std::size_t{ 1 } << Is)) != 0
+					? (result &= match_column_block(std::get<Is>(_columns).data() + begin, count, key_value<Is>(key)), 0)
+					: 0)... };
+
+				return result;
+			}
+
+			/* Returns the first row that matches the key in each column set in 'mask', or 'NotFound'. */
+			template <typename KeyT>
+			std::size_t find_row(const KeyT& key, std::size_t mask) const
+			{
+				for (std::size_t begin = 0; begin < this->size(); begin += ColumnBlockSize)
+				{
+					const auto count = std::min(ColumnBlockSize, this->size() - begin);
+					const auto matches = this->match_block(key, mask, begin, count, std::index_sequence_for<ArgTs...>{});
+
+					if (matches != 0)
+					{
+						return begin + count_trailing_zeros(matches);
+					}
+				}
+
+				return NotFound;
+			}
+
+			template <std::size_t ... Is>
+			Instance get_row(std::size_t row, std::index_sequence<Is...>) const
+			{
+				return Instance(std::get<Is>(_columns)[row]...);
+			}
+
+			template <std::size_t ... Is>
+			void push_row(const Instance& instance, std::index_sequence<Is...>)
+			{
+				using swallow = int[];
+				(void)swallow{ 0, (std::get<Is>(_columns).push_back(std::get<Is>(instance)), 0)... };
+			}
+
+			template <std::size_t ... Is>
+			void swap_remove_row(std::size_t row, std::index_sequence<Is...>)
+			{
+				using swallow = int[];
+				(void)swallow{ 0, (std::get<Is>(_columns)[row] = std::move(std::get<Is>(_columns).back()), std::get<Is>(_columns).pop_back(), 0)... };
+			}
+
+			//////////////////
+			///   Fields   ///
+		private:
+
+			std::tuple<std::vector<ArgTs>...> _columns;
+		};
+	};
+}
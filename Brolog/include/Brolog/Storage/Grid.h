@@ -0,0 +1,416 @@
+// Grid.h - Copyright (c) 2016 Will Cassella
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+#include "../Adornment.h"
+#include "../ArgPack.h"
+#include "Bits.h"
+
+namespace brolog
+{
+	/* Fact storage policy for fact types of two integer coordinates, backed by a dense bitmap over a bounded region.
+	 * Inserting, removing, and querying with both coordinates unified are single bit operations, and enumerating instances
+	 * walks the set bits a word at a time. Instances are enumerated in the same (X, Y) order as 'OrderedStorage'.
+	 * The region is grown automatically when inserting outside of it, but should be given up front with 'reserve'. It may cover at most
+	 * 'MaxArea' tiles, so this is only suited to coordinates that are close together; growing it past that throws 'std::length_error'. */
+	struct GridStorage
+	{
+		template <typename ... ArgTs>
+		struct Store;
+
+		template <typename XT, typename YT>
+		struct Store < XT, YT >
+		{
+			static_assert(std::is_integral<XT>::value && std::is_integral<YT>::value, "'GridStorage' requires integer coordinates.");
+
+			using Instance = std::tuple<XT, YT>;
+
+			using ArgPack = std::tuple<Var<XT>*, Var<YT>*>;
+
+			/* The way instances are found may be chosen at compile time, when the pattern of unified arguments is known (see 'Adornment'). */
+			using Adorned = std::true_type;
+
+			/* The number of coordinates that don't narrow the bits visited for the given pattern of unified arguments (see 'impl::predicate_cost').
+			 * A bit test is narrowed by both, a row or column walk by one, and a walk of the whole region by neither. */
+			template <std::size_t Mode>
+			using AccessCost = std::integral_constant<std::size_t, Mode == 0x3 ? 0 : Mode == 0x0 ? 2 : 1>;
+
+		private:
+
+			using Word = std::uint64_t;
+
+			static constexpr std::size_t WordBits = 64;
+
+		public:
+
+			/* The greatest number of tiles the bitmap may cover (256 MiB of bits). */
+			static constexpr std::uint64_t MaxArea = std::uint64_t{ 1 } << 31;
+
+			///////////////////
+			///   Methods   ///
+		public:
+
+			/* Unifies the given 'arg pack' with every matching instance, calling 'next' for each. */
+			template <typename ContinueFnT>
+			bool satisfy(const ArgPack& args, const ContinueFnT& next) const
+			{
+				switch (arg_pack_unified_mask<0>(args))
+				{
+				case 0x3:
+					return this->satisfy(args, next, Adornment<0x3>{});
+
+				case 0x1:
+					return this->satisfy(args, next, Adornment<0x1>{});
+
+				case 0x2:
+					return this->satisfy(args, next, Adornment<0x2>{});
+
+				default:
+					return this->satisfy(args, next, Adornment<0x0>{});
+				}
+			}
+
+			/* If both coordinates were initially unified, this is just a bit test. */
+			template <typename ContinueFnT>
+			bool satisfy(const ArgPack& args, const ContinueFnT& next, Adornment<0x3>) const
+			{
+				if (!this->contains(Instance{ std::get<0>(args)->value(), std::get<1>(args)->value() }))
+				{
+					return false;
+				}
+
+				return next();
+			}
+
+			/* Only X is unified, so walk that column of the bitmap. */
+			template <typename ContinueFnT>
+			bool satisfy(const ArgPack& args, const ContinueFnT& next, Adornment<0x1>) const
+			{
+				const auto x = std::get<0>(args)->value();
+				if (!this->x_in_bounds(x))
+				{
+					return false;
+				}
+
+				const auto column = static_cast<std::size_t>(distance(_min_x, x)) * _height;
+				return this->satisfy_bits(args, column, column + _height, next);
+			}
+
+			/* Only Y is unified, so test that row of the bitmap in each column. */
+			template <typename ContinueFnT>
+			bool satisfy(const ArgPack& args, const ContinueFnT& next, Adornment<0x2>) const
+			{
+				const auto y = std::get<1>(args)->value();
+				if (!this->y_in_bounds(y))
+				{
+					return false;
+				}
+
+				for (auto bit = static_cast<std::size_t>(distance(_min_y, y)); bit < _width * _height; bit += _height)
+				{
+					if (this->test(bit) && unify_arg_pack(args, this->get_instance(bit), next))
+					{
+						return true;
+					}
+				}
+
+				return false;
+			}
+
+			/* Nothing is unified, walk the entire bitmap. */
+			template <typename ContinueFnT>
+			bool satisfy(const ArgPack& args, const ContinueFnT& next, Adornment<0x0>) const
+			{
+				return this->satisfy_bits(args, 0, _width * _height, next);
+			}
+
+			/* Inserts the given instance. Has no effect if an equivalent instance already exists. */
+			void insert(const Instance& instance)
+			{
+				if (!this->in_bounds(instance))
+				{
+					this->grow(instance);
+				}
+
+				const auto bit = this->get_bit(instance);
+				auto& word = _bits[bit / WordBits];
+				const auto mask = Word{ 1 } << (bit % WordBits);
+
+				if ((word & mask) == 0)
+				{
+					word |= mask;
+					_size += 1;
+				}
+			}
+
+			/* Removes the given instance. Has no effect if no equivalent instance exists. */
+			void remove(const Instance& instance)
+			{
+				if (!this->in_bounds(instance))
+				{
+					return;
+				}
+
+				const auto bit = this->get_bit(instance);
+				auto& word = _bits[bit / WordBits];
+				const auto mask = Word{ 1 } << (bit % WordBits);
+
+				if ((word & mask) != 0)
+				{
+					word &= ~mask;
+					_size -= 1;
+				}
+			}
+
+			/* Returns whether an equivalent instance exists. */
+			bool contains(const Instance& instance) const
+			{
+				return this->in_bounds(instance) && this->test(this->get_bit(instance));
+			}
+
+			/* Returns the number of instances stored. */
+			std::size_t size() const
+			{
+				return _size;
+			}
+
+			/* Ensures the bitmap covers the region from (minX, minY) to (maxX, maxY), inclusive.
+			 * Throws 'std::length_error' if the resulting region would cover more than 'MaxArea' tiles. */
+			void reserve(XT minX, YT minY, XT maxX, YT maxY)
+			{
+				if (_width == 0)
+				{
+					this->resize(minX, minY, maxX, maxY);
+					return;
+				}
+
+				const auto newMinX = minX < _min_x ? minX : _min_x;
+				const auto newMinY = minY < _min_y ? minY : _min_y;
+				const auto newMaxX = maxX > this->max_x() ? maxX : this->max_x();
+				const auto newMaxY = maxY > this->max_y() ? maxY : this->max_y();
+
+				if (newMinX != _min_x || newMinY != _min_y || newMaxX != this->max_x() || newMaxY != this->max_y())
+				{
+					this->resize(newMinX, newMinY, newMaxX, newMaxY);
+				}
+			}
+
+		private:
+
+			/* Returns the distance from 'from' up to 'to' (which must not be less), without overflowing the coordinate type. */
+			template <typename T>
+			static std::uint64_t distance(T from, T to)
+			{
+				return static_cast<std::uint64_t>(to) - static_cast<std::uint64_t>(from);
+			}
+
+			/* Returns the given coordinate moved by the given (possibly negative, wrapped) distance, which must stay within its type. */
+			template <typename T>
+			static T offset(T from, std::uint64_t by)
+			{
+				return static_cast<T>(static_cast<std::uint64_t>(from) + by);
+			}
+
+			/* Returns the coordinate 'by' below the given one, or the lowest coordinate if that would pass it. */
+			template <typename T>
+			static T step_down(T from, std::uint64_t by)
+			{
+				return distance(std::numeric_limits<T>::lowest(), from) > by ? offset(from, ~by + 1) : std::numeric_limits<T>::lowest();
+			}
+
+			/* Returns the coordinate 'by' above the given one, or the greatest coordinate if that would pass it. */
+			template <typename T>
+			static T step_up(T from, std::uint64_t by)
+			{
+				return distance(from, std::numeric_limits<T>::max()) > by ? offset(from, by) : std::numeric_limits<T>::max();
+			}
+
+			/* Returns whether the region from (minX, minY) to (maxX, maxY), inclusive, covers no more than 'MaxArea' tiles. */
+			static bool fits(XT minX, YT minY, XT maxX, YT maxY)
+			{
+				const auto width = distance(minX, maxX);
+				const auto height = distance(minY, maxY);
+				return width < MaxArea && height < MaxArea && (width + 1) * (height + 1) <= MaxArea;
+			}
+
+			/* Returns the greatest X coordinate covered by the bitmap. */
+			XT max_x() const
+			{
+				return offset(_min_x, _width - 1);
+			}
+
+			/* Returns the greatest Y coordinate covered by the bitmap. */
+			YT max_y() const
+			{
+				return offset(_min_y, _height - 1);
+			}
+
+			bool x_in_bounds(XT x) const
+			{
+				return x >= _min_x && distance(_min_x, x) < _width;
+			}
+
+			bool y_in_bounds(YT y) const
+			{
+				return y >= _min_y && distance(_min_y, y) < _height;
+			}
+
+			bool in_bounds(const Instance& instance) const
+			{
+				return this->x_in_bounds(std::get<0>(instance)) && this->y_in_bounds(std::get<1>(instance));
+			}
+
+			/* Bits are laid out column-major (by X, then Y), so that increasing bit order matches (X, Y) order. */
+			std::size_t get_bit(const Instance& instance) const
+			{
+				return static_cast<std::size_t>(distance(_min_x, std::get<0>(instance)) * _height + distance(_min_y, std::get<1>(instance)));
+			}
+
+			Instance get_instance(std::size_t bit) const
+			{
+				return Instance{ offset(_min_x, bit / _height), offset(_min_y, bit % _height) };
+			}
+
+			bool test(std::size_t bit) const
+			{
+				return (_bits[bit / WordBits] & (Word{ 1 } << (bit % WordBits))) != 0;
+			}
+
+			/* Unifies the 'arg pack' with the instance for each set bit in the range [begin, end). */
+			template <typename ContinueFnT>
+			bool satisfy_bits(const ArgPack& args, std::size_t begin, std::size_t end, const ContinueFnT& next) const
+			{
+				for (auto index = begin / WordBits; index * WordBits < end; ++index)
+				{
+					auto word = _bits[index];
+
+					// Mask off the bits outside of the range
+					if (index == begin / WordBits)
+					{
+						word &= ~Word{ 0 } << (begin % WordBits);
+					}
+
+					if ((index + 1) * WordBits > end)
+					{
+						word &= ~(~Word{ 0 } << (end % WordBits));
+					}
+
+					while (word != 0)
+					{
+						const auto bit = index * WordBits + count_trailing_zeros(word);
+						word &= word - 1;
+
+						if (unify_arg_pack(args, this->get_instance(bit), next))
+						{
+							return true;
+						}
+					}
+				}
+
+				return false;
+			}
+
+			/* Grows the bitmap to cover the given instance, doubling its extent in the direction it was exceeded.
+			 * If doubling would cover more than 'MaxArea' tiles, it only grows as far as the instance. */
+			void grow(const Instance& instance)
+			{
+				const auto x = std::get<0>(instance);
+				const auto y = std::get<1>(instance);
+
+				if (_width == 0)
+				{
+					this->resize(x, y, x, y);
+					return;
+				}
+
+				// The region just covering the instance
+				const auto minX = x < _min_x ? x : _min_x;
+				const auto minY = y < _min_y ? y : _min_y;
+				const auto maxX = x > this->max_x() ? x : this->max_x();
+				const auto maxY = y > this->max_y() ? y : this->max_y();
+
+				// The region doubled in the directions it was exceeded
+				auto grownMinX = minX;
+				auto grownMinY = minY;
+				auto grownMaxX = maxX;
+				auto grownMaxY = maxY;
+
+				if (x < _min_x)
+				{
+					const auto doubled = step_down(_min_x, _width);
+					grownMinX = x < doubled ? x : doubled;
+				}
+				else if (x > this->max_x())
+				{
+					const auto doubled = step_up(this->max_x(), _width);
+					grownMaxX = x > doubled ? x : doubled;
+				}
+
+				if (y < _min_y)
+				{
+					const auto doubled = step_down(_min_y, _height);
+					grownMinY = y < doubled ? y : doubled;
+				}
+				else if (y > this->max_y())
+				{
+					const auto doubled = step_up(this->max_y(), _height);
+					grownMaxY = y > doubled ? y : doubled;
+				}
+
+				if (fits(grownMinX, grownMinY, grownMaxX, grownMaxY))
+				{
+					this->resize(grownMinX, grownMinY, grownMaxX, grownMaxY);
+				}
+				else
+				{
+					this->resize(minX, minY, maxX, maxY);
+				}
+			}
+
+			/* Reallocates the bitmap to cover the region from (minX, minY) to (maxX, maxY), inclusive, which must contain every existing instance.
+			 * Throws 'std::length_error' if it would cover more than 'MaxArea' tiles. */
+			void resize(XT minX, YT minY, XT maxX, YT maxY)
+			{
+				if (!fits(minX, minY, maxX, maxY))
+				{
+					throw std::length_error("'GridStorage' region is too large, its coordinates are too far apart.");
+				}
+
+				const auto width = static_cast<std::size_t>(distance(minX, maxX) + 1);
+				const auto height = static_cast<std::size_t>(distance(minY, maxY) + 1);
+
+				Store result;
+				result._min_x = minX;
+				result._min_y = minY;
+				result._width = width;
+				result._height = height;
+				result._bits.assign((width * height + WordBits - 1) / WordBits, 0);
+
+				for (std::size_t index = 0; index < _bits.size(); ++index)
+				{
+					for (auto word = _bits[index]; word != 0; word &= word - 1)
+					{
+						result.insert(this->get_instance(index * WordBits + count_trailing_zeros(word)));
+					}
+				}
+
+				*this = std::move(result);
+			}
+
+			//////////////////
+			///   Fields   ///
+		private:
+
+			std::vector<Word> _bits;
+			std::size_t _size = 0;
+			XT _min_x = 0;
+			YT _min_y = 0;
+			std::size_t _width = 0;
+			std::size_t _height = 0;
+		};
+	};
+}
@@ -0,0 +1,215 @@
+// Hash.h - Copyright (c) 2016 Will Cassella
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "../ArgPack.h"
+
+namespace brolog
+{
+	/* Default hash function for fact instances, combines the 'std::hash' of each element. */
+	struct InstanceHash
+	{
+		template <typename ... Ts>
+		std::size_t operator()(const std::tuple<Ts...>& instance) const
+		{
+			return combine(instance, std::index_sequence_for<Ts...>{});
+		}
+
+	private:
+
+		template <typename TupleT, std::size_t ... Is>
+		static std::size_t combine(const TupleT& instance, std::index_sequence<Is...>)
+		{
+			std::size_t result = 0;
+
+			using swallow = int[];
+			(void)swallow{ 0, (result ^= std::hash<std::tuple_element_t<Is, TupleT>>{}(std::get<Is>(instance)) + 0x9e3779b9 + (result << 6) + (result >> 2), 0)... };
+
+			return result;
+		}
+	};
+
+	/* Fact storage policy that keeps instances in an open-addressing hash set (linear probing).
+	 * Inserting, removing, and querying with all arguments unified take constant time, but instances are not kept in any
+	 * particular order, so queries with any arguments left un-unified must visit every instance.
+	 * Instance types must be default-constructible.
+	 * 'HashT' - Function object type used to hash instances of the fact type. */
+	template <typename HashT = InstanceHash>
+	struct HashStorage
+	{
+		template <typename ... ArgTs>
+		struct Store
+		{
+			using Instance = std::tuple<ArgTs...>;
+
+			using ArgPack = std::tuple<Var<ArgTs>*...>;
+
+			/* The number of arguments that don't narrow the slots visited for the given pattern of unified arguments (see 'impl::predicate_cost').
+			 * Only a fully unified key is looked up, anything else visits every slot. */
+			template <std::size_t Mode>
+			using AccessCost = std::integral_constant<std::size_t, Mode == (std::size_t{ 1 } << sizeof...(ArgTs)) - 1 ? 0 : sizeof...(ArgTs)>;
+
+		private:
+
+			struct Slot
+			{
+				bool occupied = false;
+				Instance instance;
+			};
+
+			/* The minimum number of slots to allocate, must be a power of two. */
+			static constexpr std::size_t MinCapacity = 16;
+
+			///////////////////
+			///   Methods   ///
+		public:
+
+			/* Unifies the given 'arg pack' with every matching instance, calling 'next' for each. */
+			template <typename ContinueFnT>
+			bool satisfy(const ArgPack& args, const ContinueFnT& next) const
+			{
+				// If all arguments were initially unified, this is just a membership test
+				if (arg_pack_unified<0>(args))
+				{
+					if (!this->contains(arg_pack_values(args)))
+					{
+						return false;
+					}
+
+					return next();
+				}
+
+				// Otherwise every instance must be visited
+				for (const auto& slot : _slots)
+				{
+					if (slot.occupied && unify_arg_pack(args, slot.instance, next))
+					{
+						return true;
+					}
+				}
+
+				return false;
+			}
+
+			/* Inserts the given instance. Has no effect if an equivalent instance already exists. */
+			void insert(Instance instance)
+			{
+				// Keep the load factor at or below one half
+				if ((_size + 1) * 2 > _slots.size())
+				{
+					this->rehash(_slots.empty() ? MinCapacity : _slots.size() * 2);
+				}
+
+				auto& slot = _slots[this->find_slot(instance)];
+				if (!slot.occupied)
+				{
+					slot.occupied = true;
+					slot.instance = std::move(instance);
+					_size += 1;
+				}
+			}
+
+			/* Removes the given instance. Has no effect if no equivalent instance exists. */
+			void remove(const Instance& instance)
+			{
+				if (_slots.empty())
+				{
+					return;
+				}
+
+				auto hole = this->find_slot(instance);
+				if (!_slots[hole].occupied)
+				{
+					return;
+				}
+
+				// Shift back any following instances in the same cluster that would no longer be reachable from their home slot
+				const auto mask = _slots.size() - 1;
+				for (auto pos = (hole + 1) & mask; _slots[pos].occupied; pos = (pos + 1) & mask)
+				{
+					const auto home = this->home_slot(_slots[pos].instance);
+
+					// Move the instance into the hole if the hole lies cyclically between its home slot and its current slot
+					if (((pos - home) & mask) >= ((pos - hole) & mask))
+					{
+						_slots[hole].instance = std::move(_slots[pos].instance);
+						hole = pos;
+					}
+				}
+
+				_slots[hole].occupied = false;
+				_slots[hole].instance = Instance{};
+				_size -= 1;
+			}
+
+			/* Returns whether an equivalent instance exists. */
+			bool contains(const Instance& instance) const
+			{
+				return !_slots.empty() && _slots[this->find_slot(instance)].occupied;
+			}
+
+			/* Returns the number of instances stored. */
+			std::size_t size() const
+			{
+				return _size;
+			}
+
+		private:
+
+			/* Returns the slot an instance would ideally be placed in. */
+			std::size_t home_slot(const Instance& instance) const
+			{
+				// Fibonacci hashing, so that weak hashes (such as the identity hash for integers) still spread across the table
+				const auto hash = static_cast<std::uint64_t>(_hash(instance)) * 0x9e3779b97f4a7c15ull;
+				return static_cast<std::size_t>(hash >> (64 - _capacity_log2));
+			}
+
+			/* Returns the slot containing the given instance, or the empty slot where it would be inserted. */
+			std::size_t find_slot(const Instance& instance) const
+			{
+				const auto mask = _slots.size() - 1;
+				auto pos = this->home_slot(instance);
+
+				while (_slots[pos].occupied && !(_slots[pos].instance == instance))
+				{
+					pos = (pos + 1) & mask;
+				}
+
+				return pos;
+			}
+
+			void rehash(std::size_t capacity)
+			{
+				auto oldSlots = std::move(_slots);
+				_slots = std::vector<Slot>(capacity);
+
+				_capacity_log2 = 0;
+				while ((std::size_t{ 1 } << _capacity_log2) < capacity)
+				{
+					_capacity_log2 += 1;
+				}
+
+				for (auto& slot : oldSlots)
+				{
+					if (slot.occupied)
+					{
+						auto& newSlot = _slots[this->find_slot(slot.instance)];
+						newSlot.occupied = true;
+						newSlot.instance = std::move(slot.instance);
+					}
+				}
+			}
+
+			//////////////////
+			///   Fields   ///
+		private:
+
+			std::vector<Slot> _slots;
+			std::size_t _size = 0;
+			std::size_t _capacity_log2 = 0;
+			HashT _hash;
+		};
+	};
+}
@@ -0,0 +1,458 @@
+// Ordered.h - Copyright (c) 2016 Will Cassella
+#pragma once
+
+#include <array>
+#include <functional>
+#include <set>
+#include "../Adornment.h"
+#include "../ArgPack.h"
+
+namespace brolog
+{
+	/* Declares an index on the given argument positions of a FactType, in the given order.
+	 * Queries that unify a leading run of those positions may seek into the index instead of scanning every fact. */
+	template <std::size_t ... Is>
+	struct Index
+	{
+		using Positions = tmp::index_list<Is...>;
+	};
+
+	/* Key used to look up the range of fact instances whose elements at the given positions are equal to the
+	 * values at the same positions in an 'arg pack'. The 'arg pack' must be unified at each of those positions. */
+	template <typename PositionsT, typename ArgPackT>
+	struct ArgPackKey
+	{
+		const ArgPackT& args;
+	};
+
+	/* Lexicographically compares the elements of a fact instance with the values of an 'arg pack' at the given positions, recursive.
+	 * Returns a negative number if the instance orders first, a positive number if the 'arg pack' orders first, and zero otherwise. */
+	template <typename InstanceT, typename ArgPackT, std::size_t I, std::size_t ... Is>
+	int compare_arg_pack_key(const InstanceT& instance, const ArgPackT& args, tmp::index_list<I, Is...>)
+	{
+		if (std::get<I>(instance) < std::get<I>(args)->value())
+		{
+			return -1;
+		}
+
+		if (std::get<I>(args)->value() < std::get<I>(instance))
+		{
+			return 1;
+		}
+
+		return compare_arg_pack_key(instance, args, tmp::index_list<Is...>{});
+	}
+
+	/* Recursive end-case for 'compare_arg_pack_key', the keys are equivalent. */
+	template <typename InstanceT, typename ArgPackT>
+	int compare_arg_pack_key(const InstanceT& /*instance*/, const ArgPackT& /*args*/, tmp::index_list<>)
+	{
+		return 0;
+	}
+
+	/* Ordering used for the set of fact instances. Also allows comparing instances against an 'ArgPackKey',
+	 * so that the range of instances matching a partially-unified 'arg pack' may be found without a linear scan. */
+	struct InstanceLess
+	{
+		using is_transparent = void;
+
+		template <typename InstanceT>
+		bool operator()(const InstanceT& lhs, const InstanceT& rhs) const
+		{
+			return lhs < rhs;
+		}
+
+		template <typename InstanceT, typename PositionsT, typename ArgPackT>
+		bool operator()(const InstanceT& lhs, const ArgPackKey<PositionsT, ArgPackT>& rhs) const
+		{
+			return compare_arg_pack_key(lhs, rhs.args, PositionsT{}) < 0;
+		}
+
+		template <typename PositionsT, typename ArgPackT, typename InstanceT>
+		bool operator()(const ArgPackKey<PositionsT, ArgPackT>& lhs, const InstanceT& rhs) const
+		{
+			return compare_arg_pack_key(rhs, lhs.args, PositionsT{}) > 0;
+		}
+	};
+
+	/* Ordering used for secondary indices of fact instances. Orders by the elements at the index positions,
+	 * and then by address so that distinct instances with equal keys may coexist in the index. */
+	template <std::size_t ... Is>
+	struct IndexLess
+	{
+		using is_transparent = void;
+
+		template <typename InstanceT>
+		bool operator()(const InstanceT* lhs, const InstanceT* rhs) const
+		{
+			const auto lhsKey = std::tie(std::get<Is>(*lhs)...);
+			const auto rhsKey = std::tie(std::get<Is>(*rhs)...);
+
+			if (lhsKey < rhsKey)
+			{
+				return true;
+			}
+
+			if (rhsKey < lhsKey)
+			{
+				return false;
+			}
+
+			return std::less<const InstanceT*>{}(lhs, rhs);
+		}
+
+		template <typename InstanceT, typename PositionsT, typename ArgPackT>
+		bool operator()(const InstanceT* lhs, const ArgPackKey<PositionsT, ArgPackT>& rhs) const
+		{
+			return compare_arg_pack_key(*lhs, rhs.args, PositionsT{}) < 0;
+		}
+
+		template <typename PositionsT, typename ArgPackT, typename InstanceT>
+		bool operator()(const ArgPackKey<PositionsT, ArgPackT>& lhs, const InstanceT* rhs) const
+		{
+			return compare_arg_pack_key(*rhs, lhs.args, PositionsT{}) > 0;
+		}
+	};
+
+	/* Fact storage policy that keeps instances in a lexicographically ordered set.
+	 * Queries that unify a leading run of arguments only visit the matching range of instances.
+	 * 'IndexTs' - A set of 'Index<...>' types, declaring secondary indices to maintain for other argument orders.
+	 * The index with the longest unified leading run of positions is chosen for each pattern of unified arguments. */
+	template <typename ... IndexTs>
+	struct OrderedStorage
+	{
+		template <typename ... ArgTs>
+		struct Store
+		{
+			using Instance = std::tuple<ArgTs...>;
+
+			using ArgPack = std::tuple<Var<ArgTs>*...>;
+
+			static_assert(sizeof...(ArgTs) < 16, "Too many arguments to select an index for every pattern of unified arguments.");
+
+			/* The access path may be chosen at compile time, when the pattern of unified arguments is known (see 'Adornment'). */
+			using Adorned = std::true_type;
+
+		private:
+
+			template <typename PositionsT>
+			struct IndexOf;
+
+			template <std::size_t ... Is>
+			struct IndexOf < tmp::index_list<Is...> >
+			{
+				using type = Index<Is...>;
+			};
+
+			template <typename IndexT>
+			struct IndexSet;
+
+			template <std::size_t ... Is>
+			struct IndexSet < Index<Is...> >
+			{
+				using type = std::set<const Instance*, IndexLess<Is...>>;
+			};
+
+			/* The ways in which instances may be looked up. Path 0 is the order of the instance set itself, the rest are the secondary indices. */
+			using AccessPaths = std::tuple<typename IndexOf<std::index_sequence_for<ArgTs...>>::type, IndexTs...>;
+
+			static constexpr std::size_t NumAccessPaths = 1 + sizeof...(IndexTs);
+
+			/* The access path to use for a pattern of unified arguments, and how many of its leading positions are unified. */
+			struct AccessPath
+			{
+				std::size_t index;
+				std::size_t num_unified;
+			};
+
+			////////////////////////
+			///   Constructors   ///
+		public:
+
+			Store() = default;
+			Store(const Store& copy)
+				: _instances(copy._instances)
+			{
+				// Indices refer to the instances they were built from, so they must be rebuilt
+				this->rebuild_indices();
+			}
+			Store(Store&& move) = default;
+
+			/////////////////////
+			///   Operators   ///
+		public:
+
+			Store& operator=(const Store& copy)
+			{
+				_instances = copy._instances;
+				_indices = decltype(_indices){};
+				this->rebuild_indices();
+				return *this;
+			}
+			Store& operator=(Store&& move) = default;
+
+			///////////////////
+			///   Methods   ///
+		public:
+
+			/* Unifies the given 'arg pack' with every matching instance, calling 'next' for each. */
+			template <typename ContinueFnT>
+			bool satisfy(const ArgPack& args, const ContinueFnT& next) const
+			{
+				// If all arguments were initially unified, this is just a membership test
+				if (arg_pack_unified<0>(args))
+				{
+					return this->satisfy_adorned(std::true_type{}, Adornment<(std::size_t{ 1 } << sizeof...(ArgTs)) - 1>{}, args, next);
+				}
+
+				// Otherwise, only enumerate the range of instances matching the unified arguments on the best access path
+				const auto path = select_access_path(arg_pack_unified_mask<0>(args));
+				return satisfy_access_path<0>(args, path, next);
+			}
+
+			/* Same as above, but the access path is chosen for the given pattern of unified arguments at compile time. */
+			template <typename ContinueFnT, std::size_t Mode>
+			bool satisfy(const ArgPack& args, const ContinueFnT& next, Adornment<Mode>) const
+			{
+				return this->satisfy_adorned(std::integral_constant<bool, Mode == (std::size_t{ 1 } << sizeof...(ArgTs)) - 1>{}, Adornment<Mode>{}, args, next);
+			}
+
+			/* Inserts the given instance. Has no effect if an equivalent instance already exists. */
+			void insert(Instance instance)
+			{
+				auto result = _instances.insert(std::move(instance));
+				if (result.second)
+				{
+					this->insert_indices(&*result.first, std::index_sequence_for<IndexTs...>{});
+				}
+			}
+
+			/* Removes the given instance. Has no effect if no equivalent instance exists. */
+			void remove(const Instance& instance)
+			{
+				auto pos = _instances.find(instance);
+				if (pos != _instances.end())
+				{
+					this->remove_indices(&*pos, std::index_sequence_for<IndexTs...>{});
+					_instances.erase(pos);
+				}
+			}
+
+			/* Returns whether an equivalent instance exists. */
+			bool contains(const Instance& instance) const
+			{
+				return _instances.find(instance) != _instances.end();
+			}
+
+			/* Returns the number of instances stored. */
+			std::size_t size() const
+			{
+				return _instances.size();
+			}
+
+		private:
+
+			/* Returns the number of leading positions of the given index that are unified in the given mask. */
+			static constexpr std::size_t num_unified(std::size_t /*mask*/, tmp::index_list<>)
+			{
+				return 0;
+			}
+
+			template <std::size_t I, std::size_t ... Is>
+			static constexpr std::size_t num_unified(std::size_t mask, tmp::index_list<I, Is...>)
+			{
+				return (mask & (std::size_t{ 1 } << I)) != 0 ? 1 + num_unified(mask, tmp::index_list<Is...>{}) : 0;
+			}
+
+			/* Evaluates to the access path chosen for the given mask of unified arguments, in the same way as 'choose_access_path'. */
+			template <std::size_t Mask, typename PathsT, std::size_t P = 0, std::size_t BestP = 0, std::size_t BestN = 0>
+			struct StaticAccessPath
+			{
+				static constexpr std::size_t index = BestP;
+
+				static constexpr std::size_t length = BestN;
+			};
+
+			template <std::size_t Mask, typename PathT, typename ... PathTs, std::size_t P, std::size_t BestP, std::size_t BestN>
+			struct StaticAccessPath < Mask, std::tuple<PathT, PathTs...>, P, BestP, BestN >
+				: StaticAccessPath<Mask, std::tuple<PathTs...>, P + 1,
+					(num_unified(Mask, typename PathT::Positions{}) > BestN ? P : BestP),
+					(num_unified(Mask, typename PathT::Positions{}) > BestN ? num_unified(Mask, typename PathT::Positions{}) : BestN)>
+			{
+			};
+
+		public:
+
+			/* The number of arguments that don't narrow the range visited for the given pattern of unified arguments (see 'impl::predicate_cost'),
+			 * which are those after the unified prefix of the access path chosen for it. */
+			template <std::size_t Mode>
+			using AccessCost = std::integral_constant<std::size_t, sizeof...(ArgTs) - StaticAccessPath<Mode, AccessPaths>::length>;
+
+		private:
+
+			/* Chooses the access path with the longest unified leading run of positions, preferring the instance set on ties. */
+			template <typename ... PathTs>
+			static AccessPath choose_access_path(std::size_t mask, std::tuple<PathTs...>)
+			{
+				const std::size_t numUnified[] = { num_unified(mask, typename PathTs::Positions{})... };
+				AccessPath result{ 0, numUnified[0] };
+
+				for (std::size_t i = 1; i < NumAccessPaths; ++i)
+				{
+					if (numUnified[i] > result.num_unified)
+					{
+						result = AccessPath{ i, numUnified[i] };
+					}
+				}
+
+				return result;
+			}
+
+			template <std::size_t ... Masks>
+			static std::array<AccessPath, sizeof...(Masks)> create_access_path_table(std::index_sequence<Masks...>)
+			{
+				return{ { choose_access_path(Masks, AccessPaths{})... } };
+			}
+
+			/* Returns the access path to use for the given mask of unified arguments.
+			 * The choice is only made once for each possible mask. */
+			static AccessPath select_access_path(std::size_t mask)
+			{
+				static const auto table = create_access_path_table(std::make_index_sequence<std::size_t{ 1 } << sizeof...(ArgTs)>{});
+				return table[mask];
+			}
+
+			/* Returns the container of instances for the given access path. */
+			const std::set<Instance, InstanceLess>& access_path_set(std::integral_constant<std::size_t, 0>) const
+			{
+				return _instances;
+			}
+
+			template <std::size_t P>
+			const auto& access_path_set(std::integral_constant<std::size_t, P>) const
+			{
+				return std::get<P - 1>(_indices);
+			}
+
+			static const Instance& deref(const Instance& instance)
+			{
+				return instance;
+			}
+
+			static const Instance& deref(const Instance* instance)
+			{
+				return *instance;
+			}
+
+			/* If all arguments are unified, this is just a membership test. */
+			template <std::size_t Mode, typename ContinueFnT>
+			bool satisfy_adorned(std::true_type /*unified*/, Adornment<Mode>, const ArgPack& args, const ContinueFnT& next) const
+			{
+				if (_instances.find(arg_pack_values(args)) == _instances.end())
+				{
+					return false;
+				}
+
+				return next();
+			}
+
+			template <std::size_t Mode, typename ContinueFnT>
+			bool satisfy_adorned(std::false_type /*unified*/, Adornment<Mode>, const ArgPack& args, const ContinueFnT& next) const
+			{
+				using Path = StaticAccessPath<Mode, AccessPaths>;
+				return satisfy_range<Path::index, Path::length>(args, Path::length, next);
+			}
+
+			/* Dispatches to the access path chosen at runtime. */
+			template <std::size_t P, typename ContinueFnT>
+			auto satisfy_access_path(const ArgPack& args, AccessPath path, const ContinueFnT& next) const -> std::enable_if_t<P + 1 < NumAccessPaths, bool>
+			{
+				if (path.index != P)
+				{
+					return satisfy_access_path<P + 1>(args, path, next);
+				}
+
+				return satisfy_range<P, std::tuple_element_t<P, AccessPaths>::Positions::size()>(args, path.num_unified, next);
+			}
+
+			template <std::size_t P, typename ContinueFnT>
+			auto satisfy_access_path(const ArgPack& args, AccessPath path, const ContinueFnT& next) const -> std::enable_if_t<P + 1 >= NumAccessPaths, bool>
+			{
+				return satisfy_range<P, std::tuple_element_t<P, AccessPaths>::Positions::size()>(args, path.num_unified, next);
+			}
+
+			/* Enumerates the range of instances on access path 'P' whose first 'N' positions match the arguments,
+			 * if 'N' is the number of unified leading positions. Otherwise tries again with a shorter prefix. */
+			template <std::size_t P, std::size_t N, typename ContinueFnT>
+			auto satisfy_range(const ArgPack& args, std::size_t numUnified, const ContinueFnT& next) const -> std::enable_if_t<N != 0, bool>
+			{
+				if (numUnified != N)
+				{
+					return satisfy_range<P, N - 1>(args, numUnified, next);
+				}
+
+				using Positions = typename tmp::take_indices<N, typename std::tuple_element_t<P, AccessPaths>::Positions>::type;
+				auto range = access_path_set(std::integral_constant<std::size_t, P>{}).equal_range(ArgPackKey<Positions, ArgPack>{ args });
+				for (auto instance = range.first; instance != range.second; ++instance)
+				{
+					if (unify_arg_pack(args, deref(*instance), next))
+					{
+						return true;
+					}
+				}
+
+				return false;
+			}
+
+			/* Recursive end-case for 'satisfy_range', none of the leading positions are unified so all instances are enumerated. */
+			template <std::size_t P, std::size_t N, typename ContinueFnT>
+			auto satisfy_range(const ArgPack& args, std::size_t /*numUnified*/, const ContinueFnT& next) const -> std::enable_if_t<N == 0, bool>
+			{
+				for (const auto& instance : _instances)
+				{
+					if (unify_arg_pack(args, instance, next))
+					{
+						return true;
+					}
+				}
+
+				return false;
+			}
+
+			template <std::size_t ... Ks>
+			void insert_indices(const Instance* instance, std::index_sequence<Ks...>)
+			{
+				// 'instance' is unused when there are no secondary indices
+				(void)instance;
+				using swallow = int[];
+				(void)swallow{ 0, (std::get<Ks>(_indices).insert(instance), 0)... };
+			}
+
+			template <std::size_t ... Ks>
+			void remove_indices(const Instance* instance, std::index_sequence<Ks...>)
+			{
+				// 'instance' is unused when there are no secondary indices
+				(void)instance;
+				using swallow = int[];
+				(void)swallow{ 0, (std::get<Ks>(_indices).erase(instance), 0)... };
+			}
+
+			void rebuild_indices()
+			{
+				for (const auto& instance : _instances)
+				{
+					this->insert_indices(&instance, std::index_sequence_for<IndexTs...>{});
+				}
+			}
+
+			//////////////////
+			///   Fields   ///
+		private:
+
+			std::set<Instance, InstanceLess> _instances;
+
+			/* Secondary indices, one for each of 'IndexTs'. */
+			std::tuple<typename IndexSet<IndexTs>::type...> _indices;
+		};
+	};
+}
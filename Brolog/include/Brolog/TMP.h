@@ -53,6 +53,59 @@ namespace brolog
 		{
 		};
 
+		/* Similar to 'int_list', but for indices (here used for argument positions). */
+		template <std::size_t ... Is>
+		using index_list = std::index_sequence<Is...>;
+
+		/* Given a count and an index_list, evaluates to an index_list of the first 'N' indices in the given index_list. */
+		template <std::size_t N, typename IndexList, typename Result = index_list<>>
+		struct take_indices;
+
+		template <std::size_t N, std::size_t I, std::size_t ... Is, std::size_t ... Rs>
+		struct take_indices < N, index_list<I, Is...>, index_list<Rs...> > : take_indices<N - 1, index_list<Is...>, index_list<Rs..., I>>
+		{
+		};
+
+		template <std::size_t ... Is, std::size_t ... Rs>
+		struct take_indices < 0, index_list<Is...>, index_list<Rs...> >
+		{
+			using type = index_list<Rs...>;
+		};
+
+		template <std::size_t I, std::size_t ... Is, std::size_t ... Rs>
+		struct take_indices < 0, index_list<I, Is...>, index_list<Rs...> >
+		{
+			using type = index_list<Rs...>;
+		};
+
+		/* Given a mask and a count, evaluates to an index_list of the positions below 'N' whose bits are set in the mask. */
+		template <std::size_t Mask, std::size_t N, typename Result = index_list<>>
+		struct mask_indices;
+
+		template <std::size_t Mask, std::size_t N, std::size_t ... Rs>
+		struct mask_indices < Mask, N, index_list<Rs...> >
+			: std::conditional_t<((Mask >> (N - 1)) & 1) != 0,
+				mask_indices<Mask, N - 1, index_list<N - 1, Rs...>>,
+				mask_indices<Mask, N - 1, index_list<Rs...>>>
+		{
+		};
+
+		template <std::size_t Mask, std::size_t ... Rs>
+		struct mask_indices < Mask, 0, index_list<Rs...> >
+		{
+			using type = index_list<Rs...>;
+		};
+
+		/* Replacement for C++17 'std::void_t', for detecting whether a type has a given member. */
+		template <typename ... Ts>
+		struct make_void
+		{
+			using type = void;
+		};
+
+		template <typename ... Ts>
+		using void_t = typename make_void<Ts...>::type;
+
 		/* Replacement for C++17 fold expressions, 'or'. */
 		template <bool B, bool ... Bs>
 		struct fold_or : std::integral_constant<bool, B || fold_or<Bs...>::value>
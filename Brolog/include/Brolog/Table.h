@@ -0,0 +1,175 @@
+// Table.h - Copyright (c) 2016 Will Cassella
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace brolog
+{
+	/* State shared by the answer tables of every tabled rule (see 'TabledRuleType'). */
+	struct TableBase
+	{
+		//////////////////
+		///   Fields   ///
+	public:
+
+		/* Whether every answer for this table has been found. */
+		bool complete = false;
+
+		/* Whether this table's answers are currently being found (it is on the evaluation stack). */
+		bool evaluating = false;
+
+		/* Whether this table's answers were used by a recursive call before they were complete, during the current pass. */
+		bool recursed = false;
+
+		/* The fewest answers any recursive call had used when it finished, during the current pass. */
+		std::size_t num_seen = 0;
+
+		/* This table's position on the evaluation stack. */
+		std::size_t depth = 0;
+
+		/* The lowest position on the evaluation stack of an incomplete table this table's answers depend on.
+		 * If this is equal to 'depth', this table may be completed once it reaches a fixpoint. */
+		std::size_t low = 0;
+	};
+
+	/* Per-thread state of tabled evaluation. */
+	struct TableState
+	{
+		///////////////////
+		///   Methods   ///
+	public:
+
+		/* Returns the table state for the current thread. */
+		static TableState& current()
+		{
+			thread_local TableState state;
+			return state;
+		}
+
+		//////////////////
+		///   Fields   ///
+	public:
+
+		/* The number of queries currently being run on this thread. */
+		std::size_t query_depth = 0;
+
+		/* Incremented each time an outermost query is run. Tables from a previous query are discarded when the epoch changes,
+		 * since the database may have been modified. */
+		std::size_t epoch = 0;
+
+		/* The total number of answers added to any table, used to detect when a fixpoint has been reached. */
+		std::size_t num_answers = 0;
+
+		/* Tables currently being evaluated, innermost last. */
+		std::vector<TableBase*> stack;
+
+		/* Tables that have been evaluated, but depend on a table further down the stack that has not been completed. */
+		std::vector<TableBase*> incomplete;
+	};
+
+	/* Marks the extent of a query on the current thread. Answer tables are shared by all queries nested in the outermost query. */
+	struct QueryScope
+	{
+		////////////////////////
+		///   Constructors   ///
+	public:
+
+		QueryScope()
+			: _state(TableState::current())
+		{
+			if (_state.query_depth == 0)
+			{
+				_state.epoch += 1;
+			}
+
+			_state.query_depth += 1;
+		}
+		QueryScope(const QueryScope& copy) = delete;
+		~QueryScope()
+		{
+			_state.query_depth -= 1;
+		}
+
+		//////////////////
+		///   Fields   ///
+	private:
+
+		TableState& _state;
+	};
+
+	/* Data kept in a database between queries by rule types (such as 'CachedRuleType').
+	 * Each kind of data is created the first time it is requested. Cached data is not copied along with the database. */
+	struct RuleCache
+	{
+		////////////////////////
+		///   Constructors   ///
+	public:
+
+		RuleCache() = default;
+		RuleCache(const RuleCache& /*copy*/)
+		{
+		}
+
+		///////////////////
+		///   Methods   ///
+	public:
+
+		/* Returns the data of the given type kept by the given owner (usually a rule type), creating it if it does not exist yet. */
+		template <typename OwnerT, typename T>
+		T& get()
+		{
+			// Each kind of data is given a slot the first time it is requested by any cache
+			static const std::size_t index = next_index();
+
+			if (index >= _entries.size())
+			{
+				_entries.resize(index + 1);
+			}
+
+			if (!_entries[index])
+			{
+				_entries[index] = std::make_unique<Entry<T>>();
+			}
+
+			return static_cast<Entry<T>&>(*_entries[index]).value;
+		}
+
+		/////////////////////
+		///   Operators   ///
+	public:
+
+		RuleCache& operator=(const RuleCache& /*copy*/)
+		{
+			_entries.clear();
+			return *this;
+		}
+
+	private:
+
+		struct EntryBase
+		{
+			virtual ~EntryBase() = default;
+		};
+
+		template <typename T>
+		struct Entry final : EntryBase
+		{
+			T value;
+		};
+
+		static std::size_t next_index()
+		{
+			static std::atomic<std::size_t> numIndices{ 0 };
+			return numIndices++;
+		}
+
+		//////////////////
+		///   Fields   ///
+	private:
+
+		std::vector<std::unique_ptr<EntryBase>> _entries;
+	};
+}
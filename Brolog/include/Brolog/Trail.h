@@ -0,0 +1,99 @@
+// Trail.h - Copyright (c) 2016 Will Cassella
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace brolog
+{
+	/* Record of every variable binding made during a search, so that backtracking can undo them all at once.
+	 * Each thread has its own trail, which is shared by every query run on that thread. */
+	struct Trail
+	{
+		/* Function that undoes a single binding of the given variable. */
+		using UndoFn = void(void* var);
+
+		struct Entry
+		{
+			void* var;
+			UndoFn* undo;
+		};
+
+		///////////////////
+		///   Methods   ///
+	public:
+
+		/* Returns the trail for the current thread. */
+		static Trail& current()
+		{
+			thread_local Trail trail;
+			return trail;
+		}
+
+		/* Returns the number of bindings on the trail, to be passed to 'undo' when backtracking. */
+		std::size_t mark() const
+		{
+			return _entries.size();
+		}
+
+		/* Records a binding of the given variable, to be undone with the given function. */
+		void push(void* var, UndoFn* undo)
+		{
+			_entries.push_back(Entry{ var, undo });
+		}
+
+		/* Undoes every binding made since the given mark was taken, most recent first. */
+		void undo(std::size_t mark)
+		{
+			while (_entries.size() > mark)
+			{
+				const auto entry = _entries.back();
+				_entries.pop_back();
+				entry.undo(entry.var);
+			}
+		}
+
+		//////////////////
+		///   Fields   ///
+	private:
+
+		std::vector<Entry> _entries;
+	};
+
+	/* Marks the trail on construction, and undoes every binding made since when destroyed (or when 'undo' is called).
+	 * Any predicate that binds variables should hold one of these while calling its continuation. */
+	struct ChoicePoint
+	{
+		////////////////////////
+		///   Constructors   ///
+	public:
+
+		ChoicePoint()
+			: _trail(Trail::current()),
+			_mark(_trail.mark())
+		{
+		}
+		ChoicePoint(const ChoicePoint& copy) = delete;
+		~ChoicePoint()
+		{
+			this->undo();
+		}
+
+		///////////////////
+		///   Methods   ///
+	public:
+
+		/* Undoes every binding made since this choice point was created, so that the next alternative may be tried. */
+		void undo()
+		{
+			_trail.undo(_mark);
+		}
+
+		//////////////////
+		///   Fields   ///
+	private:
+
+		Trail& _trail;
+		std::size_t _mark;
+	};
+}
@@ -1,27 +1,158 @@
 // Var.h - Copyright (c) 2016 Will Cassella
 #pragma once
 
+#include <cassert>
+#include <new>
+#include "Trail.h"
+
 namespace brolog
 {
+	template <typename T, int Name>
+	struct ReferencedVarChainElement;
+
+	/* A logic variable. A variable is a cell that may hold a value, and may instead be linked to another variable
+	 * (as done by 'ReferencedVarChainElement' to alias the vars it is given), in which case it refers to the end of the chain of links.
+	 * No operation requires a virtual call, so unification can be inlined.
+	 * Bindings are recorded on the current thread's 'Trail', and are undone by backtracking to a 'ChoicePoint'. */
 	template <typename T>
 	struct Var
 	{
+		template <typename U, int Name>
+		friend struct ReferencedVarChainElement;
+
+		////////////////////////
+		///   Constructors   ///
+	protected:
+
+		Var()
+			: _link(nullptr),
+			_unified(false)
+		{
+		}
+		Var(const Var& copy)
+			: _link(nullptr),
+			_unified(false)
+		{
+			// Links are not copied, since they are undone by whoever created them
+			if (copy._link == nullptr && copy._unified)
+			{
+				this->bind_cell(copy._value);
+			}
+		}
+		~Var()
+		{
+			if (_unified)
+			{
+				_value.~T();
+			}
+		}
+
 		///////////////////
 		///   Methods   ///
 	public:
 
 		/* Returns whether this variable has already been unified. */
-		virtual bool unified() const = 0;
+		bool unified() const
+		{
+			return this->get_cell()->_unified;
+		}
 
 		/* Returns the unified value of this variable.
 		 * NOTE: Check 'unified' before calling this function. */
-		virtual const T& value() const = 0;
+		const T& value() const
+		{
+			assert(this->unified());
+			return this->get_cell()->_value;
+		}
+
+		/* Returns whether this variable and the given variable refer to the same value (they are the same variable, or are linked together). */
+		bool aliases(const Var& other) const
+		{
+			return this->get_cell() == other.get_cell();
+		}
+
+		/* Unifies this variable with the given value.
+		 * The binding is undone when backtracking to a 'ChoicePoint' created before this call. */
+		void unify(const T& value)
+		{
+			assert(!this->unified());
+
+			auto* cell = this->get_cell();
+			cell->bind_cell(value);
+			Trail::current().push(cell, &Var::undo_bind);
+		}
+
+	protected:
+
+		/* Binds this variable without recording it on the trail, for values that outlive the search (such as query constants). */
+		void bind_cell(const T& value)
+		{
+			new (&_value) T(value);
+			_unified = true;
+		}
+
+		/* Replaces the value of this variable without recording it on the trail, binding it if it was unbound (see 'bind_cell'). */
+		void rebind_cell(const T& value)
+		{
+			if (_unified)
+			{
+				_value = value;
+			}
+			else
+			{
+				this->bind_cell(value);
+			}
+		}
+
+	private:
+
+		/* Returns the variable at the end of this variable's chain of links, which holds the value. */
+		Var* get_cell()
+		{
+			auto* cell = this;
+			while (cell->_link != nullptr)
+			{
+				cell = cell->_link;
+			}
+
+			return cell;
+		}
+
+		const Var* get_cell() const
+		{
+			return const_cast<Var*>(this)->get_cell();
+		}
+
+		/* Links this variable to the given variable, recording it on the trail. */
+		void link(Var* target)
+		{
+			_link = target;
+			Trail::current().push(this, &Var::undo_link);
+		}
+
+		static void undo_bind(void* var)
+		{
+			auto* cell = static_cast<Var*>(var);
+			cell->_unified = false;
+			cell->_value.~T();
+		}
+
+		static void undo_link(void* var)
+		{
+			static_cast<Var*>(var)->_link = nullptr;
+		}
+
+		//////////////////
+		///   Fields   ///
+	private:
 
-		/* Unifies this variable with the given value. */
-		virtual void unify(const T& value) = 0;
+		/* The variable this variable is linked to, or null if this variable holds its own value. */
+		Var* _link;
 
-		/* Deunifies this variable.
-		 * You should only call this function if you were the caller to 'unify'. */
-		virtual void unbind() = 0;
+		bool _unified;
+		union
+		{
+			T _value;
+		};
 	};
 }
@@ -2,6 +2,7 @@
 #pragma once
 
 #include <cassert>
+#include <limits>
 #include <tuple>
 #include <vector>
 #include "TMP.h"
@@ -19,65 +20,29 @@ namespace brolog
 	{
 	};
 
+	/* A var chain element that holds its own value. */
 	template <typename T, int Name>
 	struct StoredVarChainElement : VarChainElement<T, Name>
 	{
-		////////////////////////
-		///   Constructors   ///
-	public:
-
-		StoredVarChainElement()
-			: _unified(false)
-		{
-		}
-		~StoredVarChainElement()
-		{
-			if (_unified)
-			{
-				_value.~T();
-			}
-		}
-
 		///////////////////
 		///   Methods   ///
 	public:
 
-		bool unified() const final override
-		{
-			return _unified;
-		}
-
-		const T& value() const final override
-		{
-			assert(_unified);
-			return _value;
-		}
-
-		void unify(const T& value) final override
+		/* Sets the value of this variable without recording it on the trail, for constants that remain bound for the life of this element. */
+		void set_value(const T& value)
 		{
-			assert(!_unified);
-			_value = value;
-			_unified = true;
+			assert(!this->unified());
+			this->bind_cell(value);
 		}
 
-		void unbind() final override
+		/* Sets the value of this variable as with 'set_value', replacing any value it was already set to. */
+		void reset_value(const T& value)
 		{
-			assert(_unified);
-			_unified = false;
-			_value.~T();
+			this->rebind_cell(value);
 		}
-
-		//////////////////
-		///   Fields   ///
-	private:
-
-		bool _unified;
-		union
-		{
-			T _value;
-		};
 	};
 
+	/* A var chain element that aliases the vars it was given (through 'add_var'), such as a rule parameter aliasing the arguments it was called with. */
 	template <typename T, int Name>
 	struct ReferencedVarChainElement : VarChainElement<T, Name>
 	{
@@ -85,118 +50,63 @@ namespace brolog
 		///   Constructors   ///
 	public:
 
-		~ReferencedVarChainElement()
+		ReferencedVarChainElement() = default;
+		ReferencedVarChainElement(const ReferencedVarChainElement& copy)
+			: VarChainElement<T, Name>(copy)
 		{
-			// Unbind all previously unbound vars, since the stack is unwinding
-			for (auto var : _unbound)
-			{
-				if (var->unified())
-				{
-					var->unbind();
-				}
-			}
+			// Only elements that have not had vars added may be copied
+			assert(copy._link == nullptr);
 		}
 
 		///////////////////
 		///   Methods   ///
 	public:
 
-		bool unified() const final override
-		{
-			return !_vars.empty() && _vars.front()->unified();
-		}
-
-		const T& value() const final override
-		{
-			assert(this->unified());
-			return _vars.front()->value();
-		}
-
-		void unify(const T& value) final override
+		/* Adds a var to be aliased by this element, unifying it with any vars previously added.
+		 * Everything this does to the given var is recorded on the trail. Returns false if unification failed. */
+		bool add_var(Var<T>* var)
 		{
-			assert(!this->unified());
-			assert(!_vars.empty());
+			auto* cell = var->get_cell();
 
-			for (auto var : _vars)
+			// If this is the first var, just refer to it
+			if (this->_link == nullptr)
 			{
-				if (!var->unified())
-				{
-					var->unify(value);
-				}
+				this->_link = cell;
+				return true;
 			}
-		}
 
-		void unbind() final override
-		{
-			// You can only unbind this if all vars were originally unbound
-			assert(_vars.size() == _unbound.size());
-			assert(this->unified());
-			for (auto var : _vars)
+			auto* existing = this->get_cell();
+			if (existing == cell)
 			{
-				if (var->unified())
-				{
-					var->unbind();
-				}
+				// The same var was given twice
+				return true;
 			}
-		}
 
-		bool add_var(Var<T>* var)
-		{
 			// If we've already been unified (by previously adding a unified variable)
-			if (this->unified())
+			if (existing->_unified)
 			{
-				// If the variable has not been unified
-				if (!var->unified())
+				// If the variable has not been unified, unify it
+				if (!cell->_unified)
 				{
-					// Unify it, and put it in
-					var->unify(this->value());
-					_unbound.push_back(var);
-				}
-				else
-				{
-					// Make sure the variable's value works with this var's value
-					if (var->value() != this->value())
-					{
-						// Unification failed
-						return false;
-					}
+					cell->unify(existing->_value);
+					return true;
 				}
+
+				// Make sure the variable's value works with this var's value
+				return cell->_value == existing->_value;
 			}
-			else
+
+			// If the variable we're adding has been unified, unify the previous vars with its value
+			if (cell->_unified)
 			{
-				// If the variable we're adding has not been unified
-				if (!var->unified())
-				{
-					_unbound.push_back(var);
-				}
-				else
-				{
-					// Try to unify all variables with the new variable's value
-					for (auto existingVar : _vars)
-					{
-						// If we have a duplicate variable, unifying a previous one might unify a future one
-						if (!existingVar->unified())
-						{
-							existingVar->unify(var->value());
-						}
-					}
-				}
+				existing->unify(cell->_value);
+				return true;
 			}
 
-			// Add it to the list of variables
-			_vars.push_back(var);
+			// Neither is unified, so link the new variable to the previous ones, so that they're unified together
+			cell->link(existing);
 			return true;
 		}
-
-		//////////////////
-		///   Fields   ///
-	private:
-
-		/* Array of all vars referenced in this element. */
-		std::vector<Var<T>*> _vars;
-
-		/* Array of vars that were originally unbound. */
-		std::vector<Var<T>*> _unbound;
 	};
 
 	namespace impl
@@ -224,6 +134,78 @@ namespace brolog
 		};
 	}
 
+	namespace impl
+	{
+		/* Var names the library gives to arguments are reserved in separate blocks of negative names, which don't overlap each other
+		 * or the names of user vars (usually characters or small integers). From the most negative:
+		 * - 'ANONYMOUS', followed by the names given to each anonymous argument of a clause ('anonymous_name'), up to 'PLACEHOLDER_NAME_ORIGIN'.
+		 * - The names of query placeholders ('placeholder_name'), from 'PLACEHOLDER_NAME_ORIGIN' up to 'PLACEHOLDER_NAME_LIMIT'.
+		 * - The names of constants ('constant_name'), within 'CONSTANT_NAME_RANGE' of 'CONSTANT_NAME_ORIGIN', offset by their value.
+		 * Values given directly as query arguments are named from the most positive name downwards (see 'create_user_var_chain'). */
+		constexpr int PLACEHOLDER_NAME_ORIGIN = std::numeric_limits<int>::min() + (1 << 28);
+
+		constexpr int PLACEHOLDER_NAME_LIMIT = PLACEHOLDER_NAME_ORIGIN + (1 << 16);
+
+		constexpr int CONSTANT_NAME_ORIGIN = std::numeric_limits<int>::min() / 2;
+
+		constexpr int CONSTANT_NAME_RANGE = 1 << 24;
+
+		template <typename T, T Value>
+		struct constant_name : std::integral_constant<int, CONSTANT_NAME_ORIGIN + static_cast<int>(Value)>
+		{
+			static_assert(std::is_integral<T>::value || std::is_enum<T>::value, "Constant arguments must have an integral or enumeration type.");
+			static_assert(static_cast<long long>(Value) >= -CONSTANT_NAME_RANGE && static_cast<long long>(Value) <= CONSTANT_NAME_RANGE,
+				"Constant arguments must be within 'CONSTANT_NAME_RANGE' of zero.");
+		};
+
+		/* Evaluates to std::true_type if the given var name is that of a constant. */
+		template <int N>
+		struct is_constant_name
+			: std::integral_constant<bool, N >= CONSTANT_NAME_ORIGIN - CONSTANT_NAME_RANGE && N <= CONSTANT_NAME_ORIGIN + CONSTANT_NAME_RANGE>
+		{
+		};
+
+		/* Returns the value of the constant with the given var name, converted to the given type. */
+		template <typename T, int N>
+		T constant_value()
+		{
+			static_assert(is_constant_name<N>::value, "The given var name is not a constant.");
+			return static_cast<T>(N - CONSTANT_NAME_ORIGIN);
+		}
+	}
+
+	/* The var name of an argument (of a rule's parameters or predicates) with the given constant value, such as "Satisfy<FFoo, 'X', Const<int, 3>>".
+	 * A constant is unified like any other argument, and counts as unified when choosing the order of predicates and how each is satisfied
+	 * (such as which access path of a fact store to use), without the cost of a separate predicate or var chain element.
+	 * Only integral and enumeration values may be constants, and the value is converted to the type of the argument it's given for. */
+	template <typename T, T Value>
+	constexpr int Const = impl::constant_name<T, Value>::value;
+
+	/* The variable given for arguments that are the constant with the given var name. It is shared by every predicate it's given to,
+	 * which is safe since it is always bound (so nothing unifies or links it). */
+	template <typename T, int Name>
+	struct ConstantVar : Var<T>
+	{
+		////////////////////////
+		///   Constructors   ///
+	private:
+
+		ConstantVar()
+		{
+			this->bind_cell(impl::constant_value<T, Name>());
+		}
+
+		///////////////////
+		///   Methods   ///
+	public:
+
+		static Var<T>& get()
+		{
+			static ConstantVar var;
+			return var;
+		}
+	};
+
 	struct VarChainRoot {};
 
 	template <typename VarChainT, template <typename T, int N> class Element, typename ... OuterChainTs>
@@ -237,25 +219,47 @@ namespace brolog
 	{
 		return create_var_chain<
 			typename impl::AppendVarChain<
-				tmp::is_base_of_any<VarName<N>, VarChainT, OuterChainTs...>::value,
+				tmp::is_base_of_any<VarName<N>, VarChainT, OuterChainTs...>::value || impl::is_constant_name<N>::value,
 				VarChainT, T, N, Element>::result, Element>
 			(tmp::type_list<Ts...>{},
 			tmp::int_list<Ns...>{},
 			outers...);
 	}
 
-	template <std::size_t I, typename T, typename ... Ts, int N, int ... Ns, typename ArgPackT, typename VarChainT>
+	namespace impl
+	{
+		template <template <typename T, int N> class Element, typename T, int N, typename VarChainT>
+		bool add_initial_arg(std::false_type /*constant*/, Var<T>* var, VarChainT& varChain)
+		{
+			return static_cast<Element<T, N>&>(varChain).add_var(var);
+		}
+
+		template <template <typename T, int N> class Element, typename T, int N, typename VarChainT>
+		bool add_initial_arg(std::true_type /*constant*/, Var<T>* var, VarChainT& /*varChain*/)
+		{
+			// Constants have no element, so the argument is unified with the constant directly
+			if (var->unified())
+			{
+				return var->value() == constant_value<T, N>();
+			}
+
+			var->unify(constant_value<T, N>());
+			return true;
+		}
+	}
+
+	template <std::size_t I, template <typename T, int N> class Element, typename T, typename ... Ts, int N, int ... Ns, typename ArgPackT, typename VarChainT>
 	bool fill_initial_arg_chain(tmp::type_list<T, Ts...>, tmp::int_list<N, Ns...>, const ArgPackT& argPack, VarChainT& varChain)
 	{
-		if (!static_cast<ReferencedVarChainElement<T, N>&>(varChain).add_var(std::get<I>(argPack)))
+		if (!impl::add_initial_arg<Element, T, N>(impl::is_constant_name<N>{}, std::get<I>(argPack), varChain))
 		{
 			return false;
 		}
 
-		return fill_initial_arg_chain<I + 1>(tmp::type_list<Ts...>{}, tmp::int_list<Ns...>{}, argPack, varChain);
+		return fill_initial_arg_chain<I + 1, Element>(tmp::type_list<Ts...>{}, tmp::int_list<Ns...>{}, argPack, varChain);
 	}
 
-	template <std::size_t I, typename ArgPackT, typename VarChainT>
+	template <std::size_t I, template <typename T, int N> class Element, typename ArgPackT, typename VarChainT>
 	bool fill_initial_arg_chain(tmp::type_list<>, tmp::int_list<>, const ArgPackT& /*argPack*/, VarChainT& /*varChain*/)
 	{
 		return true;
@@ -264,6 +268,94 @@ namespace brolog
 	template <int N>
 	struct Unknown {};
 
+	/* A query argument whose value is ignored. It may be unified with anything, and is not given to the output function. */
+	struct Anonymous {};
+
+	/* The var name of an argument (of a rule's parameters or predicates) whose value is ignored. Each occurrence is a separate variable,
+	 * which the rest of the clause can't refer to. The most negative var names are reserved for these (see 'impl::PLACEHOLDER_NAME_ORIGIN'). */
+	constexpr int ANONYMOUS = std::numeric_limits<int>::min();
+
+	namespace impl
+	{
+		/* The var name given to the anonymous argument at the given position of a clause's predicate, where 'Depth' is the number of
+		 * var chains in scope (unique to each predicate of a clause). */
+		template <int Depth, std::size_t I>
+		struct anonymous_name : std::integral_constant<int, ANONYMOUS + 1 + Depth * 256 + static_cast<int>(I)>
+		{
+			static_assert(I < 256 && Depth < (PLACEHOLDER_NAME_ORIGIN - ANONYMOUS) / 256, "Too many predicates or arguments for anonymous arguments to be named.");
+		};
+
+		/* Given the arg types and var names of a predicate at the given depth, evaluates to the var names with each 'ANONYMOUS' replaced
+		 * by its 'anonymous_name' as 'type', the types and names of only the anonymous args as 'anonymous_types' and 'anonymous_names',
+		 * and the mask of the positions of the other args as 'named_mask'. */
+		template <
+			int Depth,
+			typename TypeList,
+			typename NameList,
+			std::size_t I = 0,
+			typename Names = tmp::int_list<>,
+			typename AnonymousTypes = tmp::type_list<>,
+			typename AnonymousNames = tmp::int_list<>,
+			std::size_t NamedMask = 0>
+		struct name_anonymous_args;
+
+		template <int Depth, typename T, typename ... Ts, int N, int ... Ns, std::size_t I, int ... Rs, typename ... As, int ... ANs, std::size_t NamedMask>
+		struct name_anonymous_args < Depth, tmp::type_list<T, Ts...>, tmp::int_list<N, Ns...>, I, tmp::int_list<Rs...>, tmp::type_list<As...>, tmp::int_list<ANs...>, NamedMask >
+			: name_anonymous_args<Depth, tmp::type_list<Ts...>, tmp::int_list<Ns...>, I + 1,
+				tmp::int_list<Rs..., N>, tmp::type_list<As...>, tmp::int_list<ANs...>, NamedMask | (std::size_t{ 1 } << I)>
+		{
+		};
+
+		template <int Depth, typename T, typename ... Ts, int ... Ns, std::size_t I, int ... Rs, typename ... As, int ... ANs, std::size_t NamedMask>
+		struct name_anonymous_args < Depth, tmp::type_list<T, Ts...>, tmp::int_list<ANONYMOUS, Ns...>, I, tmp::int_list<Rs...>, tmp::type_list<As...>, tmp::int_list<ANs...>, NamedMask >
+			: name_anonymous_args<Depth, tmp::type_list<Ts...>, tmp::int_list<Ns...>, I + 1,
+				tmp::int_list<Rs..., anonymous_name<Depth, I>::value>, tmp::type_list<As..., T>, tmp::int_list<ANs..., anonymous_name<Depth, I>::value>, NamedMask>
+		{
+		};
+
+		template <int Depth, std::size_t I, typename Names, typename AnonymousTypes, typename AnonymousNames, std::size_t NamedMask>
+		struct name_anonymous_args < Depth, tmp::type_list<>, tmp::int_list<>, I, Names, AnonymousTypes, AnonymousNames, NamedMask >
+		{
+			using type = Names;
+
+			using anonymous_types = AnonymousTypes;
+
+			using anonymous_names = AnonymousNames;
+
+			static constexpr std::size_t named_mask = NamedMask;
+		};
+
+		/* Evaluates to the predicate to satisfy in place of the given one when only the args in the given mask are named (the rest are
+		 * anonymous). This is the given predicate, unless it declares a member template 'Named' to make use of that (see 'Distinct'). */
+		template <typename PredT, std::size_t NamedMask, typename = void>
+		struct named_args
+		{
+			using type = PredT;
+		};
+
+		template <typename PredT, std::size_t NamedMask>
+		struct named_args < PredT, NamedMask, tmp::void_t<typename PredT::template Named<NamedMask>> >
+		{
+			using type = typename PredT::template Named<NamedMask>;
+		};
+	}
+
+	/* A query argument whose value is given each time the query is run, rather than when it is created (see 'Query::bind').
+	 * 'N' is the position of its value in the arguments to 'bind'. */
+	template <int N>
+	struct Placeholder {};
+
+	namespace impl
+	{
+		/* The var name of the placeholder at the given position, which does not collide with the names of user vars or generated vars
+		 * (see 'PLACEHOLDER_NAME_ORIGIN'). */
+		template <int N>
+		struct placeholder_name : std::integral_constant<int, PLACEHOLDER_NAME_ORIGIN + N>
+		{
+			static_assert(N >= 0 && N < PLACEHOLDER_NAME_LIMIT - PLACEHOLDER_NAME_ORIGIN, "Placeholder positions must be non-negative, and less than 2^16.");
+		};
+	}
+
 	template <typename VarChainT, int GenName>
 	auto create_user_var_chain(tmp::type_list<>, tmp::type_list<>)
 	{
@@ -273,6 +365,12 @@ namespace brolog
 	template <typename VarChainT, int GenName, int N, typename T, typename ... Ts, typename ... ArgTs>
 	auto create_user_var_chain(tmp::type_list<T, Ts...>, tmp::type_list<Unknown<N>, ArgTs...>);
 
+	template <typename VarChainT, int GenName, int N, typename T, typename ... Ts, typename ... ArgTs>
+	auto create_user_var_chain(tmp::type_list<T, Ts...>, tmp::type_list<Placeholder<N>, ArgTs...>);
+
+	template <typename VarChainT, int GenName, typename T, typename ... Ts, typename ... ArgTs>
+	auto create_user_var_chain(tmp::type_list<T, Ts...>, tmp::type_list<Anonymous, ArgTs...>);
+
 	template <typename VarChainT, int GenName, typename T, typename ... Ts, typename ... ArgTs>
 	auto create_user_var_chain(tmp::type_list<T, Ts...>, tmp::type_list<T, ArgTs...>)
 	{
@@ -289,6 +387,23 @@ namespace brolog
 				tmp::type_list<Ts...>{}, tmp::type_list<ArgTs...>{});
 	}
 
+	template <typename VarChainT, int GenName, int N, typename T, typename ... Ts, typename ... ArgTs>
+	auto create_user_var_chain(tmp::type_list<T, Ts...>, tmp::type_list<Placeholder<N>, ArgTs...>)
+	{
+		return create_user_var_chain<typename impl::AppendVarChain<
+			std::is_base_of<VarName<impl::placeholder_name<N>::value>, VarChainT>::value, VarChainT, T, impl::placeholder_name<N>::value, StoredVarChainElement>::result, GenName>(
+				tmp::type_list<Ts...>{}, tmp::type_list<ArgTs...>{});
+	}
+
+	template <typename VarChainT, int GenName, typename T, typename ... Ts, typename ... ArgTs>
+	auto create_user_var_chain(tmp::type_list<T, Ts...>, tmp::type_list<Anonymous, ArgTs...>)
+	{
+		// Anonymous vars are given generated names, but are never set
+		return create_user_var_chain<
+			typename impl::AppendVarChain<false, VarChainT, T, GenName, StoredVarChainElement>::result, GenName - 1>(
+			tmp::type_list<Ts...>{}, tmp::type_list<ArgTs...>{});
+	}
+
 	template <int GenName, typename VarChainT>
 	void fill_user_var_chain(VarChainT& /*varChain*/)
 	{
@@ -297,10 +412,16 @@ namespace brolog
 	template <int GenName, typename VarChainT, int N, typename ... ArgTs>
 	void fill_user_var_chain(VarChainT& varChain, Unknown<N>, const ArgTs& ... rest);
 
+	template <int GenName, typename VarChainT, int N, typename ... ArgTs>
+	void fill_user_var_chain(VarChainT& varChain, Placeholder<N>, const ArgTs& ... rest);
+
+	template <int GenName, typename VarChainT, typename ... ArgTs>
+	void fill_user_var_chain(VarChainT& varChain, Anonymous, const ArgTs& ... rest);
+
 	template <int GenName, typename VarChainT, typename T, typename ... ArgTs>
 	void fill_user_var_chain(VarChainT& varChain, const T& value, const ArgTs& ... rest)
 	{
-		static_cast<StoredVarChainElement<T, GenName>&>(varChain).unify(value);
+		static_cast<StoredVarChainElement<T, GenName>&>(varChain).set_value(value);
 		fill_user_var_chain<GenName - 1>(varChain, rest...);
 	}
 
@@ -310,6 +431,18 @@ namespace brolog
 		fill_user_var_chain<GenName>(varChain, rest...);
 	}
 
+	template <int GenName, typename VarChainT, int N, typename ... ArgTs>
+	void fill_user_var_chain(VarChainT& varChain, Placeholder<N>, const ArgTs& ... rest)
+	{
+		fill_user_var_chain<GenName>(varChain, rest...);
+	}
+
+	template <int GenName, typename VarChainT, typename ... ArgTs>
+	void fill_user_var_chain(VarChainT& varChain, Anonymous, const ArgTs& ... rest)
+	{
+		fill_user_var_chain<GenName - 1>(varChain, rest...);
+	}
+
 	template <int GenName, int ... PrevNames>
 	auto get_user_var_chain_name_list(tmp::int_list<PrevNames...> result, tmp::type_list<>)
 	{
@@ -319,6 +452,12 @@ namespace brolog
 	template <int GenName, int N, typename ... ArgTs, int ... PrevNames>
 	auto get_user_var_chain_name_list(tmp::int_list<PrevNames...>, tmp::type_list<Unknown<N>, ArgTs...>);
 
+	template <int GenName, int N, typename ... ArgTs, int ... PrevNames>
+	auto get_user_var_chain_name_list(tmp::int_list<PrevNames...>, tmp::type_list<Placeholder<N>, ArgTs...>);
+
+	template <int GenName, typename ... ArgTs, int ... PrevNames>
+	auto get_user_var_chain_name_list(tmp::int_list<PrevNames...>, tmp::type_list<Anonymous, ArgTs...>);
+
 	template <int GenName, typename T, typename ... ArgTs, int ... PrevNames>
 	auto get_user_var_chain_name_list(tmp::int_list<PrevNames...>, tmp::type_list<T, ArgTs...>)
 	{
@@ -330,4 +469,35 @@ namespace brolog
 	{
 		return get_user_var_chain_name_list<GenName>(tmp::int_list<PrevNames..., N>{}, tmp::type_list<ArgTs...>{});
 	}
+
+	template <int GenName, int N, typename ... ArgTs, int ... PrevNames>
+	auto get_user_var_chain_name_list(tmp::int_list<PrevNames...>, tmp::type_list<Placeholder<N>, ArgTs...>)
+	{
+		return get_user_var_chain_name_list<GenName>(tmp::int_list<PrevNames..., impl::placeholder_name<N>::value>{}, tmp::type_list<ArgTs...>{});
+	}
+
+	template <int GenName, typename ... ArgTs, int ... PrevNames>
+	auto get_user_var_chain_name_list(tmp::int_list<PrevNames...>, tmp::type_list<Anonymous, ArgTs...>)
+	{
+		return get_user_var_chain_name_list<GenName - 1>(tmp::int_list<PrevNames..., GenName>{}, tmp::type_list<ArgTs...>{});
+	}
+
+	template <int Name, typename T, typename ValueT>
+	void reset_user_var_chain_element(StoredVarChainElement<T, Name>& element, const ValueT& value)
+	{
+		element.reset_value(value);
+	}
+
+	/* Sets the value of each placeholder in a user var chain, starting with 'Placeholder<I>'. */
+	template <int I, typename VarChainT>
+	void bind_placeholders(VarChainT& /*varChain*/)
+	{
+	}
+
+	template <int I, typename VarChainT, typename ValueT, typename ... ValueTs>
+	void bind_placeholders(VarChainT& varChain, const ValueT& value, const ValueTs& ... rest)
+	{
+		reset_user_var_chain_element<impl::placeholder_name<I>::value>(varChain, value);
+		bind_placeholders<I + 1>(varChain, rest...);
+	}
 }
@@ -48,6 +48,23 @@ public:
 	Coordinate location;
 };
 
+/* What is known about a single tile, returned by 'KnowledgeDB::known_tiles'. */
+struct KnownTile
+{
+	//////////////////
+	///   Fields   ///
+public:
+
+	bool visited;
+	bool stench;
+	bool breeze;
+	bool obstacle;
+	bool pit;
+	bool wumpus;
+	bool dead_wumpus;
+	bool gold;
+};
+
 class KnowledgeDB
 {
 	struct Data;
@@ -96,6 +113,10 @@ public:
 	/* Returns whether the given tile is known to contain gold. Used for debugging. */
 	bool known_gold(Coordinate coord) const;
 
+	/* Returns what is known about each of the given tiles, in the same order. This is much cheaper than calling each of the
+	 * 'known_*' functions for every tile. Used for debugging. */
+	std::vector<KnownTile> known_tiles(const std::vector<Coordinate>& coords) const;
+
 private:
 
 	/* Attemps to deduce a known wumpus location, and returns whether one was found. */
@@ -2,82 +2,97 @@
 
 #include <Brolog/Brolog.h>
 #include <Brolog/Predicates/Math.h>
+#include <Brolog/Storage/Column.h>
+#include <Brolog/Storage/Grid.h>
 #include "../include/KnowledgeDB.h"
 
 /////////////////
 ///   Facts   ///
 
-/* The X and Y coordinates of a tile that has been visited. */
-using FVisited = brolog::FactType<struct CVisited, int, int>;
+/* The X and Y coordinates of a tile that has been visited.
+ * Covers the whole world, so it is stored as a grid. */
+using FVisited = brolog::BasicFactType<struct CVisited, brolog::GridStorage, int, int>;
 
-/* The X and Y coordinates of a tile in which a breeze was observed. */
-using FBreeze = brolog::FactType<struct CBreeze, int, int>;
+/* The X and Y coordinates of a tile in which a breeze was observed.
+ * Stored as a grid, which can also look up the breezes in the same row as a tile for the 'RPit' rules. */
+using FBreeze = brolog::BasicFactType<struct CBreeze, brolog::GridStorage, int, int>;
 
-/* The X and Y coordinates of a tile in which a stench was observed. */
-using FStench = brolog::FactType<struct CStench, int, int>;
+/* The X and Y coordinates of a tile in which a stench was observed.
+ * Stored as a grid, which can also look up the stenches in the same row as a tile for the 'RWumpus' rules. */
+using FStench = brolog::BasicFactType<struct CStench, brolog::GridStorage, int, int>;
 
-/* The X and Y coordinates of a tile in which a glimmer was observed. */
-using FGlimmer = brolog::FactType<struct CGlimmer, int, int>;
+/* The X and Y coordinates of a tile in which a glimmer was observed.
+ * Only ever queried with both coordinates known, so it is stored as a grid. */
+using FGlimmer = brolog::BasicFactType<struct CGlimmer, brolog::GridStorage, int, int>;
 
-/* The X and Y coordinates of a tile in which an obstacle was observed. */
-using FObstacle = brolog::FactType<struct CObstacle, int, int>;
+/* The X and Y coordinates of a tile in which an obstacle was observed.
+ * Only ever queried with both coordinates known, so it is stored as a grid. */
+using FObstacle = brolog::BasicFactType<struct CObstacle, brolog::GridStorage, int, int>;
 
-/* The X and Y coordinates of a tile in which the agent died from falling into a pit. */
-using FPitDeath = brolog::FactType<struct CPitDeath, int, int>;
+/* The X and Y coordinates of a tile in which the agent died from falling into a pit.
+ * Stored by column, since there are few of these and they are scanned. */
+using FPitDeath = brolog::BasicFactType<struct CPitDeath, brolog::ColumnStorage, int, int>;
 
-/* The X and Y coordinates of a tile in which the agent died from (being eaten by?) a wumpus. */
-using FWumpusDeath = brolog::FactType<struct CWumpusDeath, int, int>;
+/* The X and Y coordinates of a tile in which the agent died from (being eaten by?) a wumpus.
+ * Stored by column, since there are few of these and they are scanned. */
+using FWumpusDeath = brolog::BasicFactType<struct CWumpusDeath, brolog::ColumnStorage, int, int>;
 
-/* The X and Y coordinates of a tile that contains a dead wumpus. */
-using FDeadWumpus = brolog::FactType<struct DeadWumpus, int, int>;
+/* The X and Y coordinates of a tile that contains a dead wumpus.
+ * Stored by column, since there are few of these and they are scanned. */
+using FDeadWumpus = brolog::BasicFactType<struct DeadWumpus, brolog::ColumnStorage, int, int>;
 
 /////////////////
 ///   Rules   ///
 
 /* Takes a pair of X and Y coordinates (X1, Y1, X2, Y2), and resolves if they are neighbors. */
-using RNeighbor = brolog::RuleType<struct CNeighbor, int, int, int, int>;
+struct RNeighbor;
 
-/* The X and Y coordinates of all VISITED tiles in which no breeze was observed. */
-using RNoBreeze = brolog::RuleType<struct CNoBreeze, int, int>;
+/* The X and Y coordinates of all VISITED tiles in which no breeze was observed.
+ * Materialized as a grid, since it is looked up for every neighbor of a potential pit. */
+struct RNoBreeze;
 
-/* The X and Y coordinates of all VISITED tiles in which no stench was observed. */
-using RNoStench = brolog::RuleType<struct CNoStench, int, int>;
+/* The X and Y coordinates of all VISITED tiles in which no stench was observed.
+ * Materialized as a grid, since it is looked up for every neighbor of a potential wumpus. */
+struct RNoStench;
 
 /* The X and Y coordinates of all tiles in which there definately IS NOT a pit. */
-using RNotPit = brolog::RuleType<struct CNotPit, int, int>;
+struct RNotPit;
 
 /* The X and Y coordinates of all tiles in which there definately IS a pit. */
-using RPit = brolog::RuleType<struct CPit, int, int>;
+struct RPit;
 
 /* The X and Y coordinates of all tiles in which there definately IS NOT a wumpus. */
-using RNotWumpus = brolog::RuleType<struct CNotWumpus, int, int>;
+struct RNotWumpus;
 
 /* The X and Y coordinates of all tiles in which there definately IS a wumpus. */
-using RWumpus = brolog::RuleType<struct CWumpus, int, int>;
+struct RWumpus;
 
 /* The X and Y coordinates of all tiles in which there definately is nothing that will kill you. */
-using RSafe = brolog::RuleType<struct CSafe, int, int>;
+struct RSafe;
 
-/* The X and Y coordinates of all tiles that were visited and are safe to revisit. */
-using RSafeVisited = brolog::RuleType<struct CSafeVisited, int, int>;
+/* The X and Y coordinates of all tiles that were visited and are safe to revisit.
+ * Materialized as a grid, since it is looked up for every step of 'RReachable'. */
+struct RSafeVisited;
 
-/* The X and Y coordinates of all tiles that are reachable. */
-using RReachable = brolog::RuleType<struct CReachable, int, int>;
+/* The X and Y coordinates of all tiles that are reachable.
+ * Materialized by column, so that tiles are given in the order they were found rather than sorted by coordinates.
+ * Re-evaluated rather than maintained incrementally, since that would give newly reachable tiles last. */
+struct RReachable;
 
 /* The X and Y coordinates of all tiles that are reachable and unexplored. */
-using RReachableUnexplored = brolog::RuleType<struct CReachableUnexplored, int, int>;
+struct RReachableUnexplored;
 
 /* The X and Y coordinages of all tiles in which there definately is nothing that will kill you, are reachable, and have not been visited yet. */
-using RSafeReachableUnexplored = brolog::RuleType<struct CSafeReachableUnexplored, int, int>;
+struct RSafeReachableUnexplored;
 
 /* The X and Y coordinates of all tiles that there can't be prove are not safe, and have not been visited yet. */
-using RMaybeSafeReachableUnexplored = brolog::RuleType<struct CMaybeSafeReachableUnexplored, int, int>;
+struct RMaybeSafeReachableUnexplored;
 
 /* THe X and Y coordinates of tile you can shoot a wumpus tile from, given as
  * Wx, Wy, Sx, Sy */
-using RShootWumpus = brolog::RuleType<struct CShoot, int, int, int, int>;
+struct RShootWumpus;
 
-// Database type (all supported facts and rules)
+// Database type (all supported facts, rules are static)
 using WumpusWorldDB = brolog::DataBase<
 	FVisited,
 	FBreeze,
@@ -86,25 +101,10 @@ using WumpusWorldDB = brolog::DataBase<
 	FObstacle,
 	FPitDeath,
 	FWumpusDeath,
-	FDeadWumpus,
-
-	RNeighbor,
-	RNoBreeze,
-	RNoStench,
-	RNotPit,
-	RPit,
-	RNotWumpus,
-	RWumpus,
-	RSafe,
-	RSafeVisited,
-	RReachable,
-	RReachableUnexplored,
-	RSafeReachableUnexplored,
-	RMaybeSafeReachableUnexplored,
-	RShootWumpus>;
-
-/* Adds all instances of the 'RNeighbor' rule to the database. */
-void add_neighbor_rules(WumpusWorldDB& database)
+	FDeadWumpus>;
+
+/* Clauses of the 'RNeighbor' rule. */
+namespace neighbor_rules
 {
 	using namespace brolog;
 
@@ -117,25 +117,28 @@ void add_neighbor_rules(WumpusWorldDB& database)
 		NEIGHBOR_Y
 	};
 
-	// Handles case for neighbor to the left
-	database.insert_rule<RNeighbor, Params<X, Y, NEIGHBOR_X, Y>,
-		Satisfy<ConstantSum<int, -1>, NEIGHBOR_X, X>>(); // NEIGHBOR_X is X - 1
+	using Clauses = StaticRuleType<RNeighbor, tmp::type_list<int, int, int, int>,
+		// Handles case for neighbor to the left
+		Clause<Params<X, Y, NEIGHBOR_X, Y>,
+			Satisfy<ConstantSum<int, -1>, NEIGHBOR_X, X>>, // NEIGHBOR_X is X - 1
 
-	// Handles case for neighbor to the right
-	database.insert_rule<RNeighbor, Params<X, Y, NEIGHBOR_X, Y>,
-		Satisfy<ConstantSum<int, 1>, NEIGHBOR_X, X>>(); // NEIGHBOR_X is X + 1
+		// Handles case for neighbor to the right
+		Clause<Params<X, Y, NEIGHBOR_X, Y>,
+			Satisfy<ConstantSum<int, 1>, NEIGHBOR_X, X>>, // NEIGHBOR_X is X + 1
 
-	// Handles case for neighbor above
-	database.insert_rule<RNeighbor, Params<X, Y, X, NEIGHBOR_Y>,
-		Satisfy<ConstantSum<int, 1>, NEIGHBOR_Y, Y>>(); // NEIGHBOR_Y is Y + 1
+		// Handles case for neighbor above
+		Clause<Params<X, Y, X, NEIGHBOR_Y>,
+			Satisfy<ConstantSum<int, 1>, NEIGHBOR_Y, Y>>, // NEIGHBOR_Y is Y + 1
 
-	// Handles case for neighbor below
-	database.insert_rule<RNeighbor, Params<X, Y, X, NEIGHBOR_Y>,
-		Satisfy<ConstantSum<int, -1>, NEIGHBOR_Y, Y>>(); // NEIGHBOR_Y is Y - 1
+		// Handles case for neighbor below
+		Clause<Params<X, Y, X, NEIGHBOR_Y>,
+			Satisfy<ConstantSum<int, -1>, NEIGHBOR_Y, Y>>>; // NEIGHBOR_Y is Y - 1
 }
 
-/* Adds all instances of the 'RNoBreeze' rule to the database. */
-void add_no_breeze_rules(WumpusWorldDB& database)
+struct RNeighbor : neighbor_rules::Clauses {};
+
+/* Clauses of the 'RNoBreeze' rule. */
+namespace no_breeze_rules
 {
 	using namespace brolog;
 
@@ -146,15 +149,18 @@ void add_no_breeze_rules(WumpusWorldDB& database)
 		Y,
 	};
 
-	// There is no breeze in a tile if we've visited it, and we haven't recorded a breeze or an obstacle
-	database.insert_rule<RNoBreeze, Params<X, Y>,
-		Satisfy<FVisited, X, Y>,
-		NotSatisfy<FObstacle, X, Y>,
-		NotSatisfy<FBreeze, X, Y>>();
+	using Clauses = MaterializedRuleType<RNoBreeze, GridStorage, tmp::type_list<int, int>,
+		// There is no breeze in a tile if we've visited it, and we haven't recorded a breeze or an obstacle
+		Clause<Params<X, Y>,
+			Satisfy<FVisited, X, Y>,
+			NotSatisfy<FObstacle, X, Y>,
+			NotSatisfy<FBreeze, X, Y>>>;
 }
 
-/* Adds all instances of the 'RNoStench' rule to the database. */
-void add_no_stench_rules(WumpusWorldDB& database)
+struct RNoBreeze : no_breeze_rules::Clauses {};
+
+/* Clauses of the 'RNoStench' rule. */
+namespace no_stench_rules
 {
 	using namespace brolog;
 
@@ -165,15 +171,18 @@ void add_no_stench_rules(WumpusWorldDB& database)
 		Y
 	};
 
-	// There is no stench on a tile if we have visited it and we have not recorded a stench or an obstacle
-	database.insert_rule<RNoStench, Params<X, Y>,
-		Satisfy<FVisited, X, Y>,
-		NotSatisfy<FObstacle, X, Y>,
-		NotSatisfy<FStench, X, Y>>();
+	using Clauses = MaterializedRuleType<RNoStench, GridStorage, tmp::type_list<int, int>,
+		// There is no stench on a tile if we have visited it and we have not recorded a stench or an obstacle
+		Clause<Params<X, Y>,
+			Satisfy<FVisited, X, Y>,
+			NotSatisfy<FObstacle, X, Y>,
+			NotSatisfy<FStench, X, Y>>>;
 }
 
-/* Adds all instances of the RNotPit' rule to the database. */
-void add_not_pit_rules(WumpusWorldDB& database)
+struct RNoStench : no_stench_rules::Clauses {};
+
+/* Clauses of the 'RNotPit' rule. */
+namespace not_pit_rules
 {
 	using namespace brolog;
 
@@ -186,23 +195,26 @@ void add_not_pit_rules(WumpusWorldDB& database)
 		NEIGHBOR_Y
 	};
 
-	// There is not a pit on a tile if the tile contains a dead wumpus
-	database.insert_rule<RNotPit, Params<X, Y>,
-		Satisfy<FDeadWumpus, X, Y>>();
+	using Clauses = CachedRuleType<RNotPit, tmp::type_list<int, int>,
+		// There is not a pit on a tile if the tile contains a dead wumpus
+		Clause<Params<X, Y>,
+			Satisfy<FDeadWumpus, X, Y>>,
 
-	// There is not a pit on a tile if we've visited it and did not die from a pit
-	database.insert_rule<RNotPit, Params<X, Y>,
-		Satisfy<FVisited, X, Y>,
-		NotSatisfy<FPitDeath, X, Y>>();
+		// There is not a pit on a tile if we've visited it and did not die from a pit
+		Clause<Params<X, Y>,
+			Satisfy<FVisited, X, Y>,
+			NotSatisfy<FPitDeath, X, Y>>,
 
-	// There is not a pit on a tile if there is not a breeze on any of its neighbors
-	database.insert_rule<RNotPit, Params<X, Y>,
-		Satisfy<RNoBreeze, NEIGHBOR_X, NEIGHBOR_Y>,
-		Satisfy<RNeighbor, X, Y, NEIGHBOR_X, NEIGHBOR_Y>>();
+		// There is not a pit on a tile if there is not a breeze on any of its neighbors
+		Clause<Params<X, Y>,
+			Satisfy<RNoBreeze, NEIGHBOR_X, NEIGHBOR_Y>,
+			Satisfy<RNeighbor, X, Y, NEIGHBOR_X, NEIGHBOR_Y>>>;
 }
 
-/* Adds all instances of the 'RPit' rule to the database. */
-void add_pit_rules(WumpusWorldDB& database)
+struct RNotPit : not_pit_rules::Clauses {};
+
+/* Clauses of the 'RPit' rule. */
+namespace pit_rules
 {
 	using namespace brolog;
 
@@ -219,57 +231,60 @@ void add_pit_rules(WumpusWorldDB& database)
 		BELOW_BREEZE_Y
 	};
 
-	// There is a pit on the tile if we went there and died from a pit
-	database.insert_rule<RPit, Params<PIT_X, PIT_Y>,
-		Satisfy<FPitDeath, PIT_X, PIT_Y>>();
-
-	database.insert_rule<RPit, Params<PIT_X, BREEZE_Y>,
-		Satisfy<FBreeze, BREEZE_X, BREEZE_Y>, // There is a breeze on the same row as the tile
-		NotSatisfy<FPitDeath, BREEZE_X, BREEZE_Y>, // That does not originate from a time we died in a pit
-		Satisfy<ConstantSum<int, 1>, PIT_X, BREEZE_X>, // PIT_X is BREEZE_X + 1 (the breeze is to the left of the tile)
-		Satisfy<ConstantSum<int, -1>, LEFT_OF_BREEZE_X, BREEZE_X>, // LEFT_OF_BREEZE_X is BREEZE_X - 1
-		Satisfy<ConstantSum<int, -1>, BELOW_BREEZE_Y, BREEZE_Y>, // BELOW_BREEZE_Y is BREEZE_Y - 1
-		Satisfy<ConstantSum<int, 1>, ABOVE_BREEZE_Y, BREEZE_Y>, // ABOVE_BREEZE_Y is BREEZE_Y + 1
-		Satisfy<RNotPit, BREEZE_X, ABOVE_BREEZE_Y>, // There is not a pit above the breeze
-		Satisfy<RNotPit, BREEZE_X, BELOW_BREEZE_Y>, // There is not a pit below the breeze
-		Satisfy<RNotPit, LEFT_OF_BREEZE_X, BREEZE_Y>>(); // There is not a pit to the left of the breeze
-
-	database.insert_rule<RPit, Params<PIT_X, BREEZE_Y>,
-		Satisfy<FBreeze, BREEZE_X, BREEZE_Y>, // There is a breeze on the same row as the tile
-		NotSatisfy<FPitDeath, BREEZE_X, BREEZE_Y>, // That does not originate from a time we died in a pit
-		Satisfy<ConstantSum<int, -1>, PIT_X, BREEZE_X>, // PIT_X is BREEZE_X - 1 (the breeze is to the right of the tile)
-		Satisfy<ConstantSum<int, 1>, RIGHT_OF_BREEZE_X, BREEZE_X>, // RIGHT_OF_BREEZE_X is BREEZE_X + 1
-		Satisfy<ConstantSum<int, -1>, BELOW_BREEZE_Y, BREEZE_Y>, // BELOW_BREEZE_Y is PIT_Y - 1
-		Satisfy<ConstantSum<int, 1>, ABOVE_BREEZE_Y, BREEZE_Y>, // ABOVE_BREEZE_Y is PIT_Y + 1
-		Satisfy<RNotPit, BREEZE_X, ABOVE_BREEZE_Y>, // There is not a pit above the breeze
-		Satisfy<RNotPit, BREEZE_X, BELOW_BREEZE_Y>, // There is not a pit below the breeze
-		Satisfy<RNotPit, RIGHT_OF_BREEZE_X, BREEZE_Y>>(); // There is not a pit to the right of the breeze
-
-	database.insert_rule<RPit, Params<BREEZE_X, PIT_Y>,
-		Satisfy<FBreeze, BREEZE_X, BREEZE_Y>, // There is a breeze in the same column as the tile
-		NotSatisfy<FPitDeath, BREEZE_X, BREEZE_Y>, // That does not originate from a time we died in a pit
-		Satisfy<ConstantSum<int, 1>, PIT_Y, BREEZE_Y>, // PIT_Y is BREEZE_Y + 1 (the breeze is below the tile)
-		Satisfy<ConstantSum<int, -1>, BELOW_BREEZE_Y, BREEZE_Y>, // BELOW_BREEZE_Y is BREEZE_Y - 1
-		Satisfy<ConstantSum<int, -1>, LEFT_OF_BREEZE_X, BREEZE_X>, // LEFT_OF_BREEZE_X is BREEZE_X - 1
-		Satisfy<ConstantSum<int, 1>, RIGHT_OF_BREEZE_X, BREEZE_X>, // RIGHT_OF_BREEZE_X is BREEZE_X + 1
-		Satisfy<RNotPit, BREEZE_X, BELOW_BREEZE_Y>, // There is not a pit below the breeze
-		Satisfy<RNotPit, LEFT_OF_BREEZE_X, BREEZE_Y>, // There is not a pit to the left of the breeze
-		Satisfy<RNotPit, RIGHT_OF_BREEZE_X, BREEZE_Y>>(); // There is not a pit to the right of the breeze
-
-	database.insert_rule<RPit, Params<BREEZE_X, PIT_Y>,
-		Satisfy<FBreeze, BREEZE_X, BREEZE_Y>, // There is a breeze in the same column as the tile
-		NotSatisfy<FPitDeath, BREEZE_X, BREEZE_Y>, // That does not originate from a time we died in a pit
-		Satisfy<ConstantSum<int, -1>, PIT_Y, BREEZE_Y>, // PIT_Y is BREEZE_Y - 1 (the breeze is above the tile)
-		Satisfy<ConstantSum<int, 1>, ABOVE_BREEZE_Y, BREEZE_Y>, // ABOVE_BREEZE_Y is BREEZE_Y + 1
-		Satisfy<ConstantSum<int, -1>, LEFT_OF_BREEZE_X, BREEZE_X>, // LEFT_OF_BREEZE_X is BREEZE_X - 1
-		Satisfy<ConstantSum<int, 1>, RIGHT_OF_BREEZE_X, BREEZE_X>, // RIGHT_OF_BREEZE_X is BREEZE_X + 1
-		Satisfy<RNotPit, BREEZE_X, ABOVE_BREEZE_Y>, // There is not a pit above the breeze
-		Satisfy<RNotPit, LEFT_OF_BREEZE_X, BREEZE_Y>, // There is not a pit to the left of the breeze
-		Satisfy<RNotPit, RIGHT_OF_BREEZE_X, BREEZE_Y>>(); // There is not a pit to the right of the breeze
+	using Clauses = CachedRuleType<RPit, tmp::type_list<int, int>,
+		// There is a pit on the tile if we went there and died from a pit
+		Clause<Params<PIT_X, PIT_Y>,
+			Satisfy<FPitDeath, PIT_X, PIT_Y>>,
+
+		Clause<Params<PIT_X, BREEZE_Y>,
+			Satisfy<FBreeze, BREEZE_X, BREEZE_Y>, // There is a breeze on the same row as the tile
+			NotSatisfy<FPitDeath, BREEZE_X, BREEZE_Y>, // That does not originate from a time we died in a pit
+			Satisfy<ConstantSum<int, 1>, PIT_X, BREEZE_X>, // PIT_X is BREEZE_X + 1 (the breeze is to the left of the tile)
+			Satisfy<ConstantSum<int, -1>, LEFT_OF_BREEZE_X, BREEZE_X>, // LEFT_OF_BREEZE_X is BREEZE_X - 1
+			Satisfy<ConstantSum<int, -1>, BELOW_BREEZE_Y, BREEZE_Y>, // BELOW_BREEZE_Y is BREEZE_Y - 1
+			Satisfy<ConstantSum<int, 1>, ABOVE_BREEZE_Y, BREEZE_Y>, // ABOVE_BREEZE_Y is BREEZE_Y + 1
+			Satisfy<RNotPit, BREEZE_X, ABOVE_BREEZE_Y>, // There is not a pit above the breeze
+			Satisfy<RNotPit, BREEZE_X, BELOW_BREEZE_Y>, // There is not a pit below the breeze
+			Satisfy<RNotPit, LEFT_OF_BREEZE_X, BREEZE_Y>>, // There is not a pit to the left of the breeze
+
+		Clause<Params<PIT_X, BREEZE_Y>,
+			Satisfy<FBreeze, BREEZE_X, BREEZE_Y>, // There is a breeze on the same row as the tile
+			NotSatisfy<FPitDeath, BREEZE_X, BREEZE_Y>, // That does not originate from a time we died in a pit
+			Satisfy<ConstantSum<int, -1>, PIT_X, BREEZE_X>, // PIT_X is BREEZE_X - 1 (the breeze is to the right of the tile)
+			Satisfy<ConstantSum<int, 1>, RIGHT_OF_BREEZE_X, BREEZE_X>, // RIGHT_OF_BREEZE_X is BREEZE_X + 1
+			Satisfy<ConstantSum<int, -1>, BELOW_BREEZE_Y, BREEZE_Y>, // BELOW_BREEZE_Y is PIT_Y - 1
+			Satisfy<ConstantSum<int, 1>, ABOVE_BREEZE_Y, BREEZE_Y>, // ABOVE_BREEZE_Y is PIT_Y + 1
+			Satisfy<RNotPit, BREEZE_X, ABOVE_BREEZE_Y>, // There is not a pit above the breeze
+			Satisfy<RNotPit, BREEZE_X, BELOW_BREEZE_Y>, // There is not a pit below the breeze
+			Satisfy<RNotPit, RIGHT_OF_BREEZE_X, BREEZE_Y>>, // There is not a pit to the right of the breeze
+
+		Clause<Params<BREEZE_X, PIT_Y>,
+			Satisfy<FBreeze, BREEZE_X, BREEZE_Y>, // There is a breeze in the same column as the tile
+			NotSatisfy<FPitDeath, BREEZE_X, BREEZE_Y>, // That does not originate from a time we died in a pit
+			Satisfy<ConstantSum<int, 1>, PIT_Y, BREEZE_Y>, // PIT_Y is BREEZE_Y + 1 (the breeze is below the tile)
+			Satisfy<ConstantSum<int, -1>, BELOW_BREEZE_Y, BREEZE_Y>, // BELOW_BREEZE_Y is BREEZE_Y - 1
+			Satisfy<ConstantSum<int, -1>, LEFT_OF_BREEZE_X, BREEZE_X>, // LEFT_OF_BREEZE_X is BREEZE_X - 1
+			Satisfy<ConstantSum<int, 1>, RIGHT_OF_BREEZE_X, BREEZE_X>, // RIGHT_OF_BREEZE_X is BREEZE_X + 1
+			Satisfy<RNotPit, BREEZE_X, BELOW_BREEZE_Y>, // There is not a pit below the breeze
+			Satisfy<RNotPit, LEFT_OF_BREEZE_X, BREEZE_Y>, // There is not a pit to the left of the breeze
+			Satisfy<RNotPit, RIGHT_OF_BREEZE_X, BREEZE_Y>>, // There is not a pit to the right of the breeze
+
+		Clause<Params<BREEZE_X, PIT_Y>,
+			Satisfy<FBreeze, BREEZE_X, BREEZE_Y>, // There is a breeze in the same column as the tile
+			NotSatisfy<FPitDeath, BREEZE_X, BREEZE_Y>, // That does not originate from a time we died in a pit
+			Satisfy<ConstantSum<int, -1>, PIT_Y, BREEZE_Y>, // PIT_Y is BREEZE_Y - 1 (the breeze is above the tile)
+			Satisfy<ConstantSum<int, 1>, ABOVE_BREEZE_Y, BREEZE_Y>, // ABOVE_BREEZE_Y is BREEZE_Y + 1
+			Satisfy<ConstantSum<int, -1>, LEFT_OF_BREEZE_X, BREEZE_X>, // LEFT_OF_BREEZE_X is BREEZE_X - 1
+			Satisfy<ConstantSum<int, 1>, RIGHT_OF_BREEZE_X, BREEZE_X>, // RIGHT_OF_BREEZE_X is BREEZE_X + 1
+			Satisfy<RNotPit, BREEZE_X, ABOVE_BREEZE_Y>, // There is not a pit above the breeze
+			Satisfy<RNotPit, LEFT_OF_BREEZE_X, BREEZE_Y>, // There is not a pit to the left of the breeze
+			Satisfy<RNotPit, RIGHT_OF_BREEZE_X, BREEZE_Y>>>; // There is not a pit to the right of the breeze
 }
 
-/* Adds all instances of the 'RNotWumpus' rule to the database. */
-void add_not_wumpus_rules(WumpusWorldDB& database)
+struct RPit : pit_rules::Clauses {};
+
+/* Clauses of the 'RNotWumpus' rule. */
+namespace not_wumpus_rules
 {
 	using namespace brolog;
 
@@ -282,27 +297,30 @@ void add_not_wumpus_rules(WumpusWorldDB& database)
 		NEIGHBOR_Y
 	};
 
-	// There is not a wumpus on the tile if the tile contains a dead wumpus
-	database.insert_rule<RNotWumpus, Params<X, Y>,
-		Satisfy<FDeadWumpus, X, Y>>();
+	using Clauses = CachedRuleType<RNotWumpus, tmp::type_list<int, int>,
+		// There is not a wumpus on the tile if the tile contains a dead wumpus
+		Clause<Params<X, Y>,
+			Satisfy<FDeadWumpus, X, Y>>,
 
-	// There is not a wumpus on the tile if we have been there and did not die from a wumpus
-	database.insert_rule<RNotWumpus, Params<X, Y>,
-		Satisfy<FVisited, X, Y>,
-		NotSatisfy<FWumpusDeath, X, Y>>();
+		// There is not a wumpus on the tile if we have been there and did not die from a wumpus
+		Clause<Params<X, Y>,
+			Satisfy<FVisited, X, Y>,
+			NotSatisfy<FWumpusDeath, X, Y>>,
 
-	// There is not a wumpus on the tile if there is a pit on the tile
-	database.insert_rule<RNotWumpus, Params<X, Y>,
-		Satisfy<RPit, X, Y>>();
+		// There is not a wumpus on the tile if there is a pit on the tile
+		Clause<Params<X, Y>,
+			Satisfy<RPit, X, Y>>,
 
-	// There is not a wumpus on the tile if there is not a stench on one of its neighbors
-	database.insert_rule<RNotWumpus, Params<X, Y>,
-		Satisfy<RNoStench, NEIGHBOR_X, NEIGHBOR_Y>,
-		Satisfy<RNeighbor, X, Y, NEIGHBOR_X, NEIGHBOR_Y>>();
+		// There is not a wumpus on the tile if there is not a stench on one of its neighbors
+		Clause<Params<X, Y>,
+			Satisfy<RNoStench, NEIGHBOR_X, NEIGHBOR_Y>,
+			Satisfy<RNeighbor, X, Y, NEIGHBOR_X, NEIGHBOR_Y>>>;
 }
 
-/* Adds all instances of the 'RWumpus' rule to the database. */
-void add_wumpus_rules(WumpusWorldDB& database)
+struct RNotWumpus : not_wumpus_rules::Clauses {};
+
+/* Clauses of the 'RWumpus' rule. */
+namespace wumpus_rules
 {
 	using namespace brolog;
 
@@ -319,58 +337,61 @@ void add_wumpus_rules(WumpusWorldDB& database)
 		BELOW_STENCH_Y,
 	};
 
-	// A tile contains a wumpus if we've died from a wumpus and have not killed it
-	database.insert_rule<RWumpus, Params<WUMPUS_X, WUMPUS_Y>,
-		Satisfy<FWumpusDeath, WUMPUS_X, WUMPUS_Y>,
-		NotSatisfy<FDeadWumpus, WUMPUS_X, WUMPUS_Y>>();
-
-	database.insert_rule<RWumpus, Params<WUMPUS_X, STENCH_Y>,
-		Satisfy<FStench, STENCH_X, STENCH_Y>, // There is a stench in the same row as the tile
-		Satisfy<RNotWumpus, STENCH_X, STENCH_Y>, // That does NOT contain a wumpus
-		Satisfy<ConstantSum<int, 1>, WUMPUS_X, STENCH_X>, // WUMPUS_X is STENCH_X + 1 (the stench is to the left of the tile)
-		Satisfy<ConstantSum<int, -1>, LEFT_OF_STENCH_X, STENCH_X>, // LEFT_OF_STENCH_X is STENCH_X - 1
-		Satisfy<ConstantSum<int, -1>, BELOW_STENCH_Y, STENCH_Y>, // BELOW_STENCH_Y is STENCH_Y - 1
-		Satisfy<ConstantSum<int, 1>, ABOVE_STENCH_Y, STENCH_Y>, // ABOVE_STENCH_Y is STENCH_Y + 1
-		Satisfy<RNotWumpus, STENCH_X, ABOVE_STENCH_Y>, // There is not a wumpus above the stench
-		Satisfy<RNotWumpus, STENCH_X, BELOW_STENCH_Y>, // There is not a wumpus below the stench
-		Satisfy<RNotWumpus, LEFT_OF_STENCH_X, STENCH_Y>>(); // There is not a wumpus to the left of the stench
-
-	database.insert_rule<RWumpus, Params<WUMPUS_X, STENCH_Y>,
-		Satisfy<FStench, STENCH_X, STENCH_Y>, // There is a stench in the same row as the tile
-		Satisfy<RNotWumpus, STENCH_X, STENCH_Y>, // That does NOT contain a wumpus
-		Satisfy<ConstantSum<int, -1>, WUMPUS_X, STENCH_X>, // WUMPUS_X is STENCH_X - 1 (the stench is to the right of the tile)
-		Satisfy<ConstantSum<int, 1>, RIGHT_OF_STENCH_X, STENCH_X>, // RIGHT_OF_STENCH_X is STENCH_X + 1
-		Satisfy<ConstantSum<int, -1>, BELOW_STENCH_Y, STENCH_Y>, // BELOW_STENCH_Y is STENCH_Y - 1
-		Satisfy<ConstantSum<int, 1>, ABOVE_STENCH_Y, STENCH_Y>, // ABOVE_STENCH_Y is STENCH_Y + 1
-		Satisfy<RNotWumpus, STENCH_X, ABOVE_STENCH_Y>, // There is not a wumpus above the stench
-		Satisfy<RNotWumpus, STENCH_X, BELOW_STENCH_Y>, // There is not a wumpus below the stench
-		Satisfy<RNotWumpus, RIGHT_OF_STENCH_X, STENCH_Y>>(); // There is not a wumpus to the right of the stench
-
-	database.insert_rule<RWumpus, Params<STENCH_X, WUMPUS_Y>,
-		Satisfy<FStench, STENCH_X, STENCH_Y>, // There is a stench in the same column as the tile
-		Satisfy<RNotWumpus, STENCH_X, STENCH_Y>, // That does NOT contain a wumpus
-		Satisfy<ConstantSum<int, 1>, WUMPUS_Y, STENCH_Y>, // WUMPUS_Y is STENCH_Y + 1 (the stench is below the tile)
-		Satisfy<ConstantSum<int, -1>, BELOW_STENCH_Y, STENCH_Y>, // BELOW_STENCH_Y is STENCH_Y - 1
-		Satisfy<ConstantSum<int, -1>, LEFT_OF_STENCH_X, STENCH_X>, // LEFT_OF_STENCH_X is STENCH_X - 1
-		Satisfy<ConstantSum<int, 1>, RIGHT_OF_STENCH_X, STENCH_X>, // RIGHT_OF_STENCH_X is STENCH_X + 1
-		Satisfy<RNotWumpus, STENCH_X, BELOW_STENCH_Y>, // There is not a wumpus below the stench
-		Satisfy<RNotWumpus, LEFT_OF_STENCH_X, STENCH_Y>, // There is not a wumpus to the left of the stench
-		Satisfy<RNotWumpus, RIGHT_OF_STENCH_X, STENCH_Y>>(); // There is not a wumpus to the right of the stench
-
-	database.insert_rule<RWumpus, Params<STENCH_X, WUMPUS_Y>,
-		Satisfy<FStench, STENCH_X, STENCH_Y>, // There is a stench in the same column as the tile
-		Satisfy<RNotWumpus, STENCH_X, STENCH_Y>, // That does NOT contain a wumpus
-		Satisfy<ConstantSum<int, -1>, WUMPUS_Y, STENCH_Y>, // WUMPUS_Y is STENCH_Y - 1 (the stench is above the tile)
-		Satisfy<ConstantSum<int, 1>, ABOVE_STENCH_Y, STENCH_Y>, // ABOVE_STENCH_Y is STENCH_Y + 1
-		Satisfy<ConstantSum<int, -1>, LEFT_OF_STENCH_X, STENCH_X>, // LEFT_OF_STENCH_X is STENCH_X - 1
-		Satisfy<ConstantSum<int, 1>, RIGHT_OF_STENCH_X, STENCH_X>, // RIGHT_OF_STENCH_X is STENCH_X + 1
-		Satisfy<RNotWumpus, STENCH_X, ABOVE_STENCH_Y>, // There is not a wumpus above the stench
-		Satisfy<RNotWumpus, LEFT_OF_STENCH_X, STENCH_Y>, // There is not a wumpus to the left of the stench
-		Satisfy<RNotWumpus, RIGHT_OF_STENCH_X, STENCH_Y>>(); // There is not a wumpus to the right of the stench
+	using Clauses = CachedRuleType<RWumpus, tmp::type_list<int, int>,
+		// A tile contains a wumpus if we've died from a wumpus and have not killed it
+		Clause<Params<WUMPUS_X, WUMPUS_Y>,
+			Satisfy<FWumpusDeath, WUMPUS_X, WUMPUS_Y>,
+			NotSatisfy<FDeadWumpus, WUMPUS_X, WUMPUS_Y>>,
+
+		Clause<Params<WUMPUS_X, STENCH_Y>,
+			Satisfy<FStench, STENCH_X, STENCH_Y>, // There is a stench in the same row as the tile
+			Satisfy<RNotWumpus, STENCH_X, STENCH_Y>, // That does NOT contain a wumpus
+			Satisfy<ConstantSum<int, 1>, WUMPUS_X, STENCH_X>, // WUMPUS_X is STENCH_X + 1 (the stench is to the left of the tile)
+			Satisfy<ConstantSum<int, -1>, LEFT_OF_STENCH_X, STENCH_X>, // LEFT_OF_STENCH_X is STENCH_X - 1
+			Satisfy<ConstantSum<int, -1>, BELOW_STENCH_Y, STENCH_Y>, // BELOW_STENCH_Y is STENCH_Y - 1
+			Satisfy<ConstantSum<int, 1>, ABOVE_STENCH_Y, STENCH_Y>, // ABOVE_STENCH_Y is STENCH_Y + 1
+			Satisfy<RNotWumpus, STENCH_X, ABOVE_STENCH_Y>, // There is not a wumpus above the stench
+			Satisfy<RNotWumpus, STENCH_X, BELOW_STENCH_Y>, // There is not a wumpus below the stench
+			Satisfy<RNotWumpus, LEFT_OF_STENCH_X, STENCH_Y>>, // There is not a wumpus to the left of the stench
+
+		Clause<Params<WUMPUS_X, STENCH_Y>,
+			Satisfy<FStench, STENCH_X, STENCH_Y>, // There is a stench in the same row as the tile
+			Satisfy<RNotWumpus, STENCH_X, STENCH_Y>, // That does NOT contain a wumpus
+			Satisfy<ConstantSum<int, -1>, WUMPUS_X, STENCH_X>, // WUMPUS_X is STENCH_X - 1 (the stench is to the right of the tile)
+			Satisfy<ConstantSum<int, 1>, RIGHT_OF_STENCH_X, STENCH_X>, // RIGHT_OF_STENCH_X is STENCH_X + 1
+			Satisfy<ConstantSum<int, -1>, BELOW_STENCH_Y, STENCH_Y>, // BELOW_STENCH_Y is STENCH_Y - 1
+			Satisfy<ConstantSum<int, 1>, ABOVE_STENCH_Y, STENCH_Y>, // ABOVE_STENCH_Y is STENCH_Y + 1
+			Satisfy<RNotWumpus, STENCH_X, ABOVE_STENCH_Y>, // There is not a wumpus above the stench
+			Satisfy<RNotWumpus, STENCH_X, BELOW_STENCH_Y>, // There is not a wumpus below the stench
+			Satisfy<RNotWumpus, RIGHT_OF_STENCH_X, STENCH_Y>>, // There is not a wumpus to the right of the stench
+
+		Clause<Params<STENCH_X, WUMPUS_Y>,
+			Satisfy<FStench, STENCH_X, STENCH_Y>, // There is a stench in the same column as the tile
+			Satisfy<RNotWumpus, STENCH_X, STENCH_Y>, // That does NOT contain a wumpus
+			Satisfy<ConstantSum<int, 1>, WUMPUS_Y, STENCH_Y>, // WUMPUS_Y is STENCH_Y + 1 (the stench is below the tile)
+			Satisfy<ConstantSum<int, -1>, BELOW_STENCH_Y, STENCH_Y>, // BELOW_STENCH_Y is STENCH_Y - 1
+			Satisfy<ConstantSum<int, -1>, LEFT_OF_STENCH_X, STENCH_X>, // LEFT_OF_STENCH_X is STENCH_X - 1
+			Satisfy<ConstantSum<int, 1>, RIGHT_OF_STENCH_X, STENCH_X>, // RIGHT_OF_STENCH_X is STENCH_X + 1
+			Satisfy<RNotWumpus, STENCH_X, BELOW_STENCH_Y>, // There is not a wumpus below the stench
+			Satisfy<RNotWumpus, LEFT_OF_STENCH_X, STENCH_Y>, // There is not a wumpus to the left of the stench
+			Satisfy<RNotWumpus, RIGHT_OF_STENCH_X, STENCH_Y>>, // There is not a wumpus to the right of the stench
+
+		Clause<Params<STENCH_X, WUMPUS_Y>,
+			Satisfy<FStench, STENCH_X, STENCH_Y>, // There is a stench in the same column as the tile
+			Satisfy<RNotWumpus, STENCH_X, STENCH_Y>, // That does NOT contain a wumpus
+			Satisfy<ConstantSum<int, -1>, WUMPUS_Y, STENCH_Y>, // WUMPUS_Y is STENCH_Y - 1 (the stench is above the tile)
+			Satisfy<ConstantSum<int, 1>, ABOVE_STENCH_Y, STENCH_Y>, // ABOVE_STENCH_Y is STENCH_Y + 1
+			Satisfy<ConstantSum<int, -1>, LEFT_OF_STENCH_X, STENCH_X>, // LEFT_OF_STENCH_X is STENCH_X - 1
+			Satisfy<ConstantSum<int, 1>, RIGHT_OF_STENCH_X, STENCH_X>, // RIGHT_OF_STENCH_X is STENCH_X + 1
+			Satisfy<RNotWumpus, STENCH_X, ABOVE_STENCH_Y>, // There is not a wumpus above the stench
+			Satisfy<RNotWumpus, LEFT_OF_STENCH_X, STENCH_Y>, // There is not a wumpus to the left of the stench
+			Satisfy<RNotWumpus, RIGHT_OF_STENCH_X, STENCH_Y>>>; // There is not a wumpus to the right of the stench
 }
 
-/* Adds all instances of the 'RSafe' rule to the database. */
-void add_safe_rules(WumpusWorldDB& database)
+struct RWumpus : wumpus_rules::Clauses {};
+
+/* Clauses of the 'RSafe' rule. */
+namespace safe_rules
 {
 	using namespace brolog;
 
@@ -381,14 +402,17 @@ void add_safe_rules(WumpusWorldDB& database)
 		Y
 	};
 
-	// A tile is safe if it does not contain a wumpus or a pit
-	database.insert_rule<RSafe, Params<X, Y>,
-		Satisfy<RNotPit, X, Y>,
-		Satisfy<RNotWumpus, X, Y>>();
+	using Clauses = StaticRuleType<RSafe, tmp::type_list<int, int>,
+		// A tile is safe if it does not contain a wumpus or a pit
+		Clause<Params<X, Y>,
+			Satisfy<RNotPit, X, Y>,
+			Satisfy<RNotWumpus, X, Y>>>;
 }
 
-/* Adds all instances of the 'RSafeVisited' rule to the database. */
-void add_safe_visited_rules(WumpusWorldDB& database)
+struct RSafe : safe_rules::Clauses {};
+
+/* Clauses of the 'RSafeVisited' rule. */
+namespace safe_visited_rules
 {
 	using namespace brolog;
 
@@ -399,21 +423,24 @@ void add_safe_visited_rules(WumpusWorldDB& database)
 		Y
 	};
 
-	// A tile is safe and visited if it has been visited, and we were not killed by a pit or a wumpus
-	database.insert_rule<RSafeVisited, Params<X, Y>,
-		Satisfy<FVisited, X, Y>,
-		NotSatisfy<FPitDeath, X, Y>,
-		NotSatisfy<FWumpusDeath, X, Y>>();
-
-	// A tile is safe and visited if it has been visited, we were not killed by a pit, and there is a dead wumpus on it
-	database.insert_rule<RSafeVisited, Params<X, Y>,
-		Satisfy<FVisited, X, Y>,
-		NotSatisfy<FPitDeath, X, Y>,
-		Satisfy<FDeadWumpus, X, Y>>();
+	using Clauses = MaterializedRuleType<RSafeVisited, GridStorage, tmp::type_list<int, int>,
+		// A tile is safe and visited if it has been visited, and we were not killed by a pit or a wumpus
+		Clause<Params<X, Y>,
+			Satisfy<FVisited, X, Y>,
+			NotSatisfy<FPitDeath, X, Y>,
+			NotSatisfy<FWumpusDeath, X, Y>>,
+
+		// A tile is safe and visited if it has been visited, we were not killed by a pit, and there is a dead wumpus on it
+		Clause<Params<X, Y>,
+			Satisfy<FVisited, X, Y>,
+			NotSatisfy<FPitDeath, X, Y>,
+			Satisfy<FDeadWumpus, X, Y>>>;
 }
 
-/* Adds all instances of the 'RReachable' rule to the database. */
-void add_reachable_rules(WumpusWorldDB& database)
+struct RSafeVisited : safe_visited_rules::Clauses {};
+
+/* Clauses of the 'RReachable' rule. */
+namespace reachable_rules
 {
 	using namespace brolog;
 
@@ -426,16 +453,19 @@ void add_reachable_rules(WumpusWorldDB& database)
 		NEIGHBOR_Y
 	};
 
-	// A tile is reachable if it neighbors a safe visited tile that is not an obstacle, and it itself is not proven to be an obstacle
-	database.insert_rule<RReachable, Params<X, Y>,
-		Satisfy<RSafeVisited, NEIGHBOR_X, NEIGHBOR_Y>,
-		NotSatisfy<FObstacle, NEIGHBOR_X, NEIGHBOR_Y>,
-		Satisfy<RNeighbor, X, Y, NEIGHBOR_X, NEIGHBOR_Y>,
-		NotSatisfy<FObstacle, X, Y>>();
+	using Clauses = BasicMaterializedRuleType<RReachable, ColumnStorage, FullReevaluation, tmp::type_list<int, int>,
+		// A tile is reachable if it neighbors a safe visited tile that is not an obstacle, and it itself is not proven to be an obstacle
+		Clause<Params<X, Y>,
+			Satisfy<RSafeVisited, NEIGHBOR_X, NEIGHBOR_Y>,
+			NotSatisfy<FObstacle, NEIGHBOR_X, NEIGHBOR_Y>,
+			Satisfy<RNeighbor, X, Y, NEIGHBOR_X, NEIGHBOR_Y>,
+			NotSatisfy<FObstacle, X, Y>>>;
 }
 
-/* Adds all instances of the 'RReachableUnexplored' rules to the database. */
-void add_reachable_unexplored_rules(WumpusWorldDB& database)
+struct RReachable : reachable_rules::Clauses {};
+
+/* Clauses of the 'RReachableUnexplored' rule. */
+namespace reachable_unexplored_rules
 {
 	using namespace brolog;
 
@@ -446,14 +476,17 @@ void add_reachable_unexplored_rules(WumpusWorldDB& database)
 		Y
 	};
 
-	// A tile is reachable and unexplored if it is reachable and not visited
-	database.insert_rule<RReachableUnexplored, Params<X, Y>,
-		Satisfy<RReachable, X, Y>,
-		NotSatisfy<FVisited, X, Y>>();
+	using Clauses = StaticRuleType<RReachableUnexplored, tmp::type_list<int, int>,
+		// A tile is reachable and unexplored if it is reachable and not visited
+		Clause<Params<X, Y>,
+			Satisfy<RReachable, X, Y>,
+			NotSatisfy<FVisited, X, Y>>>;
 }
 
-/* Adds all instances of the 'RSafeReachableUnexplored' rules to the database. */
-void add_safe_reachable_unexplored_rules(WumpusWorldDB& database)
+struct RReachableUnexplored : reachable_unexplored_rules::Clauses {};
+
+/* Clauses of the 'RSafeReachableUnexplored' rule. */
+namespace safe_reachable_unexplored_rules
 {
 	using namespace brolog;
 
@@ -464,14 +497,17 @@ void add_safe_reachable_unexplored_rules(WumpusWorldDB& database)
 		Y
 	};
 
-	// A tile is safe and reachable and unexplored if it is reachable, unexplored, and proven to be safe
-	database.insert_rule<RSafeReachableUnexplored, Params<X, Y>,
-		Satisfy<RReachableUnexplored, X, Y>,
-		Satisfy<RSafe, X, Y>>();
+	using Clauses = CachedRuleType<RSafeReachableUnexplored, tmp::type_list<int, int>,
+		// A tile is safe and reachable and unexplored if it is reachable, unexplored, and proven to be safe
+		Clause<Params<X, Y>,
+			Satisfy<RReachableUnexplored, X, Y>,
+			Satisfy<RSafe, X, Y>>>;
 }
 
-/* Adds all instances of the 'RMaybeSafeReachableUnexplored' rules to the database. */
-void add_maybe_safe_reachable_unexplored_rules(WumpusWorldDB& database)
+struct RSafeReachableUnexplored : safe_reachable_unexplored_rules::Clauses {};
+
+/* Clauses of the 'RMaybeSafeReachableUnexplored' rule. */
+namespace maybe_safe_reachable_unexplored_rules
 {
 	using namespace brolog;
 
@@ -482,14 +518,18 @@ void add_maybe_safe_reachable_unexplored_rules(WumpusWorldDB& database)
 		Y
 	};
 
-	// A tile is maybe safe, reachable, and unexplored if it is reachable and unexplored, and not proven to be a pit or a wumpus
-	database.insert_rule<RMaybeSafeReachableUnexplored, Params<X, Y>,
-		Satisfy<RReachableUnexplored, X, Y>,
-		NotSatisfy<RPit, X, Y>,
-		NotSatisfy<RWumpus, X, Y>>();
+	using Clauses = CachedRuleType<RMaybeSafeReachableUnexplored, tmp::type_list<int, int>,
+		// A tile is maybe safe, reachable, and unexplored if it is reachable and unexplored, and not proven to be a pit or a wumpus
+		Clause<Params<X, Y>,
+			Satisfy<RReachableUnexplored, X, Y>,
+			NotSatisfy<RPit, X, Y>,
+			NotSatisfy<RWumpus, X, Y>>>;
 }
 
-void add_shoot_wumpus_rules(WumpusWorldDB& database)
+struct RMaybeSafeReachableUnexplored : maybe_safe_reachable_unexplored_rules::Clauses {};
+
+/* Clauses of the 'RShootWumpus' rule. */
+namespace shoot_wumpus_rules
 {
 	using namespace brolog;
 
@@ -502,40 +542,79 @@ void add_shoot_wumpus_rules(WumpusWorldDB& database)
 		SAFE_NEIGHBOR_Y
 	};
 
-	// You can shoot a wumpus from a safe neighboring tile that is not an obstacle (keep it simple)
-	database.insert_rule<RShootWumpus, Params<X, Y, SAFE_NEIGHBOR_X, SAFE_NEIGHBOR_Y>,
-		Satisfy<RWumpus, X, Y>,
-		Satisfy<RNeighbor, X, Y, SAFE_NEIGHBOR_X, SAFE_NEIGHBOR_Y>,
-		Satisfy<RSafeVisited, SAFE_NEIGHBOR_X, SAFE_NEIGHBOR_Y>,
-		NotSatisfy<FObstacle, SAFE_NEIGHBOR_X, SAFE_NEIGHBOR_Y>>();
+	using Clauses = CachedRuleType<RShootWumpus, tmp::type_list<int, int, int, int>,
+		// You can shoot a wumpus from a safe neighboring tile that is not an obstacle (keep it simple)
+		Clause<Params<X, Y, SAFE_NEIGHBOR_X, SAFE_NEIGHBOR_Y>,
+			Satisfy<RWumpus, X, Y>,
+			Satisfy<RNeighbor, X, Y, SAFE_NEIGHBOR_X, SAFE_NEIGHBOR_Y>,
+			Satisfy<RSafeVisited, SAFE_NEIGHBOR_X, SAFE_NEIGHBOR_Y>,
+			NotSatisfy<FObstacle, SAFE_NEIGHBOR_X, SAFE_NEIGHBOR_Y>>>;
 }
 
+struct RShootWumpus : shoot_wumpus_rules::Clauses {};
+
 //////////////////////////////
 ///   Knowledge Database   ///
 
+/* A query for whether a fact or rule holds on a tile, whose coordinates are bound before each run. */
+template <typename PredT>
+using TileQuery = decltype(std::declval<const WumpusWorldDB&>().create_query<PredT>(brolog::Placeholder<0>(), brolog::Placeholder<1>()));
+
 struct KnowledgeDB::Data
 {
+	////////////////////////
+	///   Constructors   ///
+public:
+
+	Data()
+		: visited(create_tile_query<FVisited>()),
+		stench(create_tile_query<FStench>()),
+		breeze(create_tile_query<FBreeze>()),
+		obstacle(create_tile_query<FObstacle>()),
+		pit(create_tile_query<RPit>()),
+		wumpus(create_tile_query<RWumpus>()),
+		dead_wumpus(create_tile_query<FDeadWumpus>()),
+		gold(create_tile_query<FGlimmer>())
+	{
+	}
+
+	///////////////////
+	///   Methods   ///
+private:
+
+	template <typename PredT>
+	TileQuery<PredT> create_tile_query() const
+	{
+		return database.create_query<PredT>(brolog::Placeholder<0>(), brolog::Placeholder<1>());
+	}
+
+	//////////////////
+	///   Fields   ///
+public:
+
 	WumpusWorldDB database;
+
+	// Queries for the 'known_*' and 'known_tiles' functions, which are run for every tile by the debug printer
+	TileQuery<FVisited> visited;
+	TileQuery<FStench> stench;
+	TileQuery<FBreeze> breeze;
+	TileQuery<FObstacle> obstacle;
+	TileQuery<RPit> pit;
+	TileQuery<RWumpus> wumpus;
+	TileQuery<FDeadWumpus> dead_wumpus;
+	TileQuery<FGlimmer> gold;
 };
 
 KnowledgeDB::KnowledgeDB(int size)
 {
-	// Add all rules to the database
 	_data = std::make_unique<Data>();
-	add_neighbor_rules(_data->database);
-	add_no_breeze_rules(_data->database);
-	add_no_stench_rules(_data->database);
-	add_not_pit_rules(_data->database);
-	add_pit_rules(_data->database);
-	add_not_wumpus_rules(_data->database);
-	add_wumpus_rules(_data->database);
-	add_safe_rules(_data->database);
-	add_safe_visited_rules(_data->database);
-	add_reachable_rules(_data->database);
-	add_reachable_unexplored_rules(_data->database);
-	add_safe_reachable_unexplored_rules(_data->database);
-	add_maybe_safe_reachable_unexplored_rules(_data->database);
-	add_shoot_wumpus_rules(_data->database);
+
+	// Size the grid facts to cover the world and its walls
+	_data->database.get_fact_store<FVisited>().reserve(-1, -1, size, size);
+	_data->database.get_fact_store<FBreeze>().reserve(-1, -1, size, size);
+	_data->database.get_fact_store<FStench>().reserve(-1, -1, size, size);
+	_data->database.get_fact_store<FGlimmer>().reserve(-1, -1, size, size);
+	_data->database.get_fact_store<FObstacle>().reserve(-1, -1, size, size);
 
 	// Add walls to the database
 	for (int i = 0; i < size; ++i)
@@ -576,7 +655,7 @@ Action KnowledgeDB::next_action(const Player& player) const
 		// Figure out where to shoot the wumpus from
 		using namespace brolog;
 		auto query = _data->database.create_query<RShootWumpus>(wumpusCoords.x, wumpusCoords.y, Unknown<'X'>(), Unknown<'Y'>());
-		query([&](auto x, auto y) {
+		query.first([&](auto x, auto y) {
 			result.location.x = x;
 			result.location.y = y;
 		});
@@ -716,16 +795,17 @@ bool KnowledgeDB::next_wumpus(Coordinate& coords) const
 {
 	auto query = _data->database.create_query<RWumpus>(brolog::Unknown<'X'>(), brolog::Unknown<'Y'>());
 
-	return query([&](int x, int y) {
+	return query.first([&](int x, int y) {
 		coords.x = x;
 		coords.y = y;
-	}) != 0;
+	});
 }
 
 bool KnowledgeDB::next_safe_unexplored(Coordinate& coords) const
 {
 	auto query = _data->database.create_query<RSafeReachableUnexplored>(brolog::Unknown<'X'>(), brolog::Unknown<'Y'>());
 
+	// Use the last tile found (the furthest from the visited tiles), so every answer is needed
 	return query([&](int x, int y) {
 		coords.x = x;
 		coords.y = y;
@@ -737,6 +817,7 @@ bool KnowledgeDB::next_maybe_safe_unexplored(Coordinate& coords) const
 	// Attempt to satisfy the 'MaysafeReachableUnexplored' rule where both arguments are unknown.
 	auto query = _data->database.create_query<RMaybeSafeReachableUnexplored>(brolog::Unknown<'X'>(), brolog::Unknown<'Y'>());
 
+	// Use the last tile found, as with 'next_safe_unexplored'
 	return query([&](int x, int y) {
 		coords.x = x;
 		coords.y = y;
@@ -745,40 +826,71 @@ bool KnowledgeDB::next_maybe_safe_unexplored(Coordinate& coords) const
 
 bool KnowledgeDB::known_visited(Coordinate coords) const
 {
-	return _data->database.create_query<FVisited>(coords.x, coords.y)([]() {}) != 0;
+	return _data->visited.bind(coords.x, coords.y).exists();
 }
 
 bool KnowledgeDB::known_stench(Coordinate coords) const
 {
-	return _data->database.create_query<FStench>(coords.x, coords.y)([]() {}) != 0;
+	return _data->stench.bind(coords.x, coords.y).exists();
 }
 
 bool KnowledgeDB::known_breeze(Coordinate coords) const
 {
-	return _data->database.create_query<FBreeze>(coords.x, coords.y)([]() {}) != 0;
+	return _data->breeze.bind(coords.x, coords.y).exists();
 }
 
 bool KnowledgeDB::known_obstacle(Coordinate coords) const
 {
-	return _data->database.create_query<FObstacle>(coords.x, coords.y)([]() {}) != 0;
+	return _data->obstacle.bind(coords.x, coords.y).exists();
 }
 
 bool KnowledgeDB::known_pit(Coordinate coords) const
 {
-	return _data->database.create_query<RPit>(coords.x, coords.y)([]() {}) != 0;
+	return _data->pit.bind(coords.x, coords.y).exists();
 }
 
 bool KnowledgeDB::known_wumpus(Coordinate coords) const
 {
-	return _data->database.create_query<RWumpus>(coords.x, coords.y)([]() {}) != 0;
+	return _data->wumpus.bind(coords.x, coords.y).exists();
 }
 
 bool KnowledgeDB::known_dead_wumpus(Coordinate coords) const
 {
-	return _data->database.create_query<FDeadWumpus>(coords.x, coords.y)([]() {}) != 0;
+	return _data->dead_wumpus.bind(coords.x, coords.y).exists();
 }
 
 bool KnowledgeDB::known_gold(Coordinate coord) const
 {
-	return _data->database.create_query<FGlimmer>(coord.x, coord.y)([]() {}) != 0;
+	return _data->gold.bind(coord.x, coord.y).exists();
+}
+
+std::vector<KnownTile> KnowledgeDB::known_tiles(const std::vector<Coordinate>& coords) const
+{
+	// Each tile query is run once for all of the given tiles
+	std::vector<std::tuple<int, int>> keys;
+	keys.reserve(coords.size());
+
+	for (const auto& coord : coords)
+	{
+		keys.emplace_back(coord.x, coord.y);
+	}
+
+	auto visited = _data->visited.exists_each(keys);
+	auto stench = _data->stench.exists_each(keys);
+	auto breeze = _data->breeze.exists_each(keys);
+	auto obstacle = _data->obstacle.exists_each(keys);
+	auto pit = _data->pit.exists_each(keys);
+	auto wumpus = _data->wumpus.exists_each(keys);
+	auto deadWumpus = _data->dead_wumpus.exists_each(keys);
+	auto gold = _data->gold.exists_each(keys);
+
+	std::vector<KnownTile> result;
+	result.reserve(coords.size());
+
+	for (std::size_t i = 0; i < coords.size(); ++i)
+	{
+		result.push_back(KnownTile{ visited[i], stench[i], breeze[i], obstacle[i], pit[i], wumpus[i], deadWumpus[i], gold[i] });
+	}
+
+	return result;
 }
@@ -7,14 +7,30 @@
 
 void debug_print(int worldSize, const Coordinate& pos, const KnowledgeDB& database)
 {
+	// Look up every tile at once, in the order they're printed
+	std::vector<Coordinate> tiles;
+	tiles.reserve(worldSize * worldSize);
+
 	for (int y = worldSize - 1; y >= 0; --y)
 	{
 		for (int x = 0; x < worldSize; ++x)
+		{
+			tiles.push_back(Coordinate{ x, y });
+		}
+	}
+
+	auto known = database.known_tiles(tiles);
+	std::size_t tile = 0;
+
+	for (int y = worldSize - 1; y >= 0; --y)
+	{
+		for (int x = 0; x < worldSize; ++x, ++tile)
 		{
 			Coordinate coords{ x, y };
-			bool visited = database.known_visited(coords);
+			const auto& info = known[tile];
+			bool visited = info.visited;
 
-			if (database.known_gold(coords))
+			if (info.gold)
 			{
 				printf("$");
 			}
@@ -31,14 +47,14 @@ void debug_print(int worldSize, const Coordinate& pos, const KnowledgeDB& databa
 				printf("(");
 			}
 
-			if (database.known_obstacle(coords))
+			if (info.obstacle)
 			{
 				printf("XXX> ");
 				continue;
 			}
 
 			// If the tile contains a stench
-			if (database.known_stench(coords))
+			if (info.stench)
 			{
 				printf("s");
 			}
@@ -48,7 +64,7 @@ void debug_print(int worldSize, const Coordinate& pos, const KnowledgeDB& databa
 			}
 
 			// If the tile contains a breeze
-			if (database.known_breeze(coords))
+			if (info.breeze)
 			{
 				printf("b");
 			}
@@ -58,15 +74,15 @@ void debug_print(int worldSize, const Coordinate& pos, const KnowledgeDB& databa
 			}
 
 			// If the tile contains a pit
-			if (database.known_pit(coords))
+			if (info.pit)
 			{
 				printf("P");
 			}
-			else if (database.known_wumpus(coords))
+			else if (info.wumpus)
 			{
 				printf("W");
 			}
-			else if (database.known_dead_wumpus(coords))
+			else if (info.dead_wumpus)
 			{
 				printf("D");
 			}
@@ -75,7 +91,7 @@ void debug_print(int worldSize, const Coordinate& pos, const KnowledgeDB& databa
 				printf(" ");
 			}
 
-			if (database.known_gold(coords))
+			if (info.gold)
 			{
 				printf("$ ");
 			}